@@ -0,0 +1,390 @@
+/*
+    Algorithms - sort, par_sort, simd, heap, btree
+    against qsort, <algorithm>, std::priority_queue and std::map
+    eytz lookups against algo_lower_bound (riff_sorted), bsearch, hhmap and std::lower_bound
+*/
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <thread>
+
+static int riff_less_i32(const int32_t* a, const int32_t* b)   { return *a < *b; }
+static int riff_less_u64(const uint64_t* a, const uint64_t* b) { return *a < *b; }
+static void riff_add_i32(int32_t* acc, const int32_t* v)       { *acc += *v; }
+
+static int qsort_cmp_i32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static int bsearch_cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+#define RIFF_KEY_I32(p) riff_radix_key_i32(*(p))
+
+#define T i32, int32_t,
+#define A malloc, realloc, free
+#include "riff/dynamic_array.h"
+
+#define T i32, int32_t, riff_less_i32, RIFF_KEY_I32
+#define A malloc, realloc, free
+#include "riff/algorithms.h"
+
+#define T i32, int32_t, riff_less_i32, riff_add_i32
+#define A malloc, realloc, free
+#include "riff/parallel.h"
+
+#define T i32, int32_t, i32
+#define A malloc, realloc, free
+#include "riff/simd.h"
+
+#define T h2, uint64_t, , riff_less_u64, 2
+#define A malloc, realloc, free
+#include "riff/heap.h"
+
+#define T h4, uint64_t, , riff_less_u64, 4
+#define A malloc, realloc, free
+#include "riff/heap.h"
+
+#define T h8, uint64_t, , riff_less_u64, 8
+#define A malloc, realloc, free
+#include "riff/heap.h"
+
+#define T u64, uint64_t, , uint64_t, , riff_less_u64
+#define A malloc, realloc, free
+#include "riff/btree.h"
+
+#define T u64, uint64_t, riff_less_u64
+#define A malloc, realloc, free
+#include "riff/algorithms.h"
+
+#define T u64, uint64_t, riff_less_u64
+#define A malloc, realloc, free
+#include "riff/eytzinger.h"
+
+#include "riff/hash.h"
+
+#define T u64, uint64_t, , uint64_t, , riff_hash_u64, riff_equal_u64
+#define A malloc, realloc, free
+#include "riff/hashmap.h"
+
+namespace bench {
+
+namespace {
+
+const char* dist_name(bool zipf) {
+    return zipf ? "zipf" : "uniform";
+}
+
+// n values, uniform over the whole int32 range or zipf (many duplicates)
+std::vector<int32_t> values_i32(size_t n, bool zipf, uint64_t seed) {
+    std::vector<int32_t> out(n);
+    if (zipf) {
+        std::vector<size_t> ranks = indices(n, n, true, seed);
+        for (size_t i = 0; i < n; i++) out[i] = (int32_t)(mix64(ranks[i]) >> 32);
+    }
+    else {
+        Rng rng(seed);
+        for (auto& v : out) v = (int32_t)rng.next();
+    }
+    return out;
+}
+
+void bench_sort(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        for (bool zipf : { false, true }) {
+            std::vector<int32_t> input = values_i32(n, zipf, 5);
+            std::vector<int32_t> data;
+            auto reset = [&] { data = input; };
+            const char* dist = dist_name(zipf);
+
+            run(ctx, "sort", "sort", "riff_introsort", dist, -1, n, n, reset,
+                [&] { algo_sort(i32)(data.data(), n); });
+            run(ctx, "sort", "sort", "riff_stable", dist, -1, n, n, reset,
+                [&] { algo_stable_sort(i32)(data.data(), n); });
+            run(ctx, "sort", "sort", "riff_radix", dist, -1, n, n, reset,
+                [&] { algo_radix_sort(i32)(data.data(), n); });
+            run(ctx, "sort", "sort", "qsort", dist, -1, n, n, reset,
+                [&] { std::qsort(data.data(), n, sizeof(int32_t), qsort_cmp_i32); });
+            run(ctx, "sort", "sort", "std_sort", dist, -1, n, n, reset,
+                [&] { std::sort(data.begin(), data.end()); });
+            run(ctx, "sort", "sort", "std_stable", dist, -1, n, n, reset,
+                [&] { std::stable_sort(data.begin(), data.end()); });
+        }
+    }
+}
+
+void bench_par(Context& ctx) {
+    size_t cores = std::thread::hardware_concurrency();
+    if (cores == 0) cores = 1;
+
+    // 1, 2, 4 ... threads up to the core count (at least 4, to show oversubscription too)
+    std::vector<size_t> counts;
+    for (size_t t = 1; t <= std::max<size_t>(cores, 4); t *= 2) counts.push_back(t);
+    if (counts.back() != cores && cores > 4) counts.push_back(cores);
+
+    for (size_t n : ctx.sizes()) {
+        std::vector<int32_t> input = values_i32(n, false, 11);
+        std::vector<int32_t> data;
+        auto reset = [&] { data = input; };
+
+        for (size_t t : counts) {
+            std::string impl = "riff_t" + std::to_string(t);
+
+            run(ctx, "par", "sort", impl, "uniform", -1, n, n, reset,
+                [&] { par_sort(i32)(data.data(), n, t); });
+            run(ctx, "par", "prefix_sum", impl, "uniform", -1, n, n, reset,
+                [&] { par_prefix_sum(i32)(data.data(), n, t); });
+            run(ctx, "par", "reduce", impl, "uniform", -1, n, n, reset,
+                [&] {
+                    int32_t sum;
+                    par_reduce(i32)(data.data(), n, t, &sum);
+                    keep((uint32_t)sum);
+                });
+        }
+    }
+}
+
+void bench_simd(Context& ctx) {
+    struct Level { int level; const char* name; };
+    const Level levels[] = {
+        { RIFF_SIMD_LEVEL_SCALAR, "riff_scalar" },
+        { RIFF_SIMD_LEVEL_SSE2,   "riff_sse2"   },
+        { RIFF_SIMD_LEVEL_AVX2,   "riff_avx2"   },
+    };
+    int supported = riff_simd_supported_level();
+
+    for (size_t n : ctx.sizes()) {
+        // values in [0, 1000), searched value absent so find scans everything
+        std::vector<int32_t> data(n);
+        Rng rng(3);
+        for (auto& v : data) v = (int32_t)rng.below(1000);
+
+        dyarr(i32) out;
+        dyarr_zero(i32)(&out);
+        std::vector<int32_t> std_out;
+
+        for (const Level& l : levels) {
+            if (l.level > supported) continue;
+            riff_simd_set_level(l.level);
+
+            run(ctx, "simd", "find", l.name, "uniform", 0, n, n, [] {},
+                [&] { size_t i; keep(simd_find(i32)(data.data(), n, -1, &i)); });
+            run(ctx, "simd", "count", l.name, "uniform", -1, n, n, [] {},
+                [&] { keep(simd_count(i32)(data.data(), n, 7)); });
+            run(ctx, "simd", "sum", l.name, "uniform", -1, n, n, [] {},
+                [&] { keep(simd_sum(i32)(data.data(), n)); });
+            run(ctx, "simd", "min", l.name, "uniform", -1, n, n, [] {},
+                [&] { int32_t m = 0; simd_min(i32)(data.data(), n, &m); keep((uint32_t)m); });
+            run(ctx, "simd", "filter_range", l.name, "uniform", -1, n, n,
+                [&] { dyarr_clear(i32)(&out); },
+                [&] { simd_filter_range(i32)(data.data(), n, 250, 749, &out); });
+        }
+        riff_simd_set_level(supported);
+
+        run(ctx, "simd", "find", "std", "uniform", 0, n, n, [] {},
+            [&] { keep(std::find(data.begin(), data.end(), -1) - data.begin()); });
+        run(ctx, "simd", "count", "std", "uniform", -1, n, n, [] {},
+            [&] { keep(std::count(data.begin(), data.end(), 7)); });
+        run(ctx, "simd", "sum", "std", "uniform", -1, n, n, [] {},
+            [&] { keep(std::accumulate(data.begin(), data.end(), (int64_t)0)); });
+        run(ctx, "simd", "min", "std", "uniform", -1, n, n, [] {},
+            [&] { keep((uint32_t)*std::min_element(data.begin(), data.end())); });
+        run(ctx, "simd", "filter_range", "std", "uniform", -1, n, n,
+            [&] { std_out.clear(); },
+            [&] { std::copy_if(data.begin(), data.end(), std::back_inserter(std_out),
+                               [](int32_t v) { return v >= 250 && v <= 749; }); });
+
+        dyarr_destroy(i32)(&out);
+    }
+}
+
+// push all then pop all, ops = pushes + pops
+template <class Heap, class Zero, class Push, class Pop, class Destroy>
+void heap_case(Context& ctx, const char* impl, size_t n, const std::vector<uint64_t>& input,
+               Zero zero, Push push, Pop pop, Destroy destroy) {
+    Heap h;
+    zero(&h);
+    run(ctx, "heap", "push_pop", impl, "uniform", -1, n, 2 * n,
+        [&] { destroy(&h); },
+        [&] {
+            uint64_t sum = 0, v;
+            for (uint64_t x : input) push(&h, x);
+            while (pop(&h, &v)) sum += v;
+            keep(sum);
+        });
+    destroy(&h);
+}
+
+void bench_heap(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        std::vector<uint64_t> input = distinct_keys(n, 8);
+
+        heap_case<heap(h2)>(ctx, "riff_d2", n, input, heap_zero(h2), heap_push(h2), heap_pop(h2), heap_destroy(h2));
+        heap_case<heap(h4)>(ctx, "riff_d4", n, input, heap_zero(h4), heap_push(h4), heap_pop(h4), heap_destroy(h4));
+        heap_case<heap(h8)>(ctx, "riff_d8", n, input, heap_zero(h8), heap_push(h8), heap_pop(h8), heap_destroy(h8));
+
+        using StdHeap = std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>>;
+        StdHeap sh;
+        run(ctx, "heap", "push_pop", "std", "uniform", -1, n, 2 * n,
+            [&] { sh = StdHeap(); },
+            [&] {
+                uint64_t sum = 0;
+                for (uint64_t x : input) sh.push(x);
+                while (!sh.empty()) { sum += sh.top(); sh.pop(); }
+                keep(sum);
+            });
+    }
+}
+
+void bench_btree(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        // first n keys are inserted, the other n are guaranteed misses
+        std::vector<uint64_t> keys = distinct_keys(2 * n, 42);
+
+        btree(u64) t;
+        btree_zero(u64)(&t);
+        std::map<uint64_t, uint64_t> sm;
+
+        run(ctx, "btree", "insert", "riff", "uniform", -1, n, n,
+            [&] { btree_destroy(u64)(&t); },
+            [&] { for (size_t i = 0; i < n; i++) btree_push(u64)(&t, keys[i], i); });
+        run(ctx, "btree", "insert", "std", "uniform", -1, n, n,
+            [&] { sm.clear(); },
+            [&] { for (size_t i = 0; i < n; i++) sm.emplace(keys[i], i); });
+
+        for (bool zipf : { false, true }) {
+            for (double hit : { 1.0, 0.0 }) {
+                std::vector<size_t> picks = indices(n, n, zipf, 7);
+                std::vector<uint64_t> queries(n);
+                for (size_t i = 0; i < n; i++) queries[i] = keys[picks[i] + (hit > 0 ? 0 : n)];
+
+                run(ctx, "btree", "find", "riff", dist_name(zipf), hit, n, n, [] {},
+                    [&] {
+                        uint64_t sum = 0;
+                        uint64_t* v;
+                        for (uint64_t q : queries) if (btree_find(u64)(&t, q, NULL, &v)) sum += *v;
+                        keep(sum);
+                    });
+                run(ctx, "btree", "find", "std", dist_name(zipf), hit, n, n, [] {},
+                    [&] {
+                        uint64_t sum = 0;
+                        for (uint64_t q : queries) {
+                            auto it = sm.find(q);
+                            if (it != sm.end()) sum += it->second;
+                        }
+                        keep(sum);
+                    });
+            }
+        }
+
+        run(ctx, "btree", "iterate", "riff", "seq", -1, n, n, [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (btree_iter(u64) it = btree_first(u64)(&t); btree_valid(u64)(it); it = btree_next(u64)(it)) sum += *btree_value(u64)(it);
+                keep(sum);
+            });
+        run(ctx, "btree", "iterate", "std", "seq", -1, n, n, [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (const auto& kv : sm) sum += kv.second;
+                keep(sum);
+            });
+
+        std::vector<uint64_t> sorted(keys.begin(), keys.begin() + n);
+        std::sort(sorted.begin(), sorted.end());
+        run(ctx, "btree", "bulk_load", "riff", "seq", -1, n, n,
+            [&] { btree_destroy(u64)(&t); },
+            [&] { btree_bulk_load(u64)(&t, sorted.data(), sorted.data(), n); });
+        run(ctx, "btree", "bulk_load", "std", "seq", -1, n, n,
+            [&] { sm.clear(); },
+            [&] { for (uint64_t k : sorted) sm.emplace_hint(sm.end(), k, k); });
+
+        btree_destroy(u64)(&t);
+    }
+}
+
+void bench_eytz(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        std::vector<uint64_t> sorted = distinct_keys(n, 83);
+        std::sort(sorted.begin(), sorted.end());
+
+        eytz(u64) e;
+        eytz_zero(u64)(&e);
+        run(ctx, "eytz", "build", "riff", "seq", -1, n, n, [] {},
+            [&] { eytz_build(u64)(&e, sorted.data(), n); });
+
+        hhmap(u64) m;
+        hhmap_zero(u64)(&m);
+        for (uint64_t k : sorted) hhmap_push(u64)(&m, k, k);
+
+        // lookups of present keys in random order, as of a static table
+        std::vector<size_t>   picks = indices(n, n, false, 89);
+        std::vector<uint64_t> queries(n);
+        for (size_t i = 0; i < n; i++) queries[i] = sorted[picks[i]];
+        std::vector<const uint64_t*> found(n);
+
+        run(ctx, "eytz", "lower_bound", "riff", "uniform", 1, n, n, [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (const uint64_t& q : queries) sum += *eytz_lower_bound(u64)(&e, &q);
+                keep(sum);
+            });
+        run(ctx, "eytz", "lower_bound", "riff_batch", "uniform", 1, n, n, [] {},
+            [&] {
+                uint64_t sum = 0;
+                eytz_lower_bound_many(u64)(&e, queries.data(), n, found.data());
+                for (const uint64_t* f : found) sum += *f;
+                keep(sum);
+            });
+        run(ctx, "eytz", "lower_bound", "riff_sorted", "uniform", 1, n, n, [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (const uint64_t& q : queries) sum += sorted[algo_lower_bound(u64)(sorted.data(), n, &q)];
+                keep(sum);
+            });
+        run(ctx, "eytz", "lower_bound", "bsearch", "uniform", 1, n, n, [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (const uint64_t& q : queries) sum += *(const uint64_t*)bsearch(&q, sorted.data(), n, sizeof(uint64_t), bsearch_cmp_u64);
+                keep(sum);
+            });
+        run(ctx, "eytz", "lower_bound", "std", "uniform", 1, n, n, [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (uint64_t q : queries) sum += *std::lower_bound(sorted.begin(), sorted.end(), q);
+                keep(sum);
+            });
+        run(ctx, "eytz", "lower_bound", "riff_hhmap", "uniform", 1, n, n, [] {},
+            [&] {
+                uint64_t sum = 0;
+                uint64_t* v;
+                for (uint64_t q : queries) if (hhmap_find(u64)(&m, q, NULL, &v)) sum += *v;
+                keep(sum);
+            });
+
+        eytz_destroy(u64)(&e);
+        hhmap_destroy(u64)(&m);
+    }
+}
+
+} // namespace
+
+void algorithms(Context& ctx) {
+    if (ctx.enabled("sort"))  bench_sort(ctx);
+    if (ctx.enabled("par"))   bench_par(ctx);
+    if (ctx.enabled("simd"))  bench_simd(ctx);
+    if (ctx.enabled("heap"))  bench_heap(ctx);
+    if (ctx.enabled("btree")) bench_btree(ctx);
+    if (ctx.enabled("eytz"))  bench_eytz(ctx);
+}
+
+} // namespace bench
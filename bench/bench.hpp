@@ -0,0 +1,201 @@
+/*
+    Benchmark harness
+
+    Every benchmark case reports a row:
+        suite, bench, impl, dist, hit, size, ops, value, unit
+    suite     - benchmarked area (dyarr, hhmap, sort, ...)
+    bench     - workload (push, find, churn, ...)
+    impl      - implementation (riff, std, ...)
+    dist      - key / access distribution (seq, uniform, zipf)
+    hit       - ratio of successful lookups, -1 if not applicable
+    size      - element count the workload operates on
+    ops       - operations timed (or samples measured)
+    value     - measured value, for timings best run time / ops
+    unit      - unit of value, ns_per_op for timings, quality measures name their own
+
+    Results are printed as CSV (default) or JSON, so runs of different commits can be diffed
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/*
+    Options / Results
+*/
+
+struct Options {
+    std::string format   = "csv";
+    std::string filter;                 // run only suites containing this substring
+    size_t      min_size = size_t(1) << 10;
+    size_t      max_size = size_t(1) << 22;
+    int         repeats  = 3;           // best of repeats is reported
+};
+
+struct Result {
+    std::string suite;
+    std::string bench;
+    std::string impl;
+    std::string dist;
+    double      hit;
+    size_t      size;
+    size_t      ops;
+    double      value;
+    std::string unit;
+};
+
+struct Context {
+    Options             opt;
+    std::vector<Result> results;
+
+    bool enabled(const char* suite) const {
+        return opt.filter.empty() || std::string(suite).find(opt.filter) != std::string::npos;
+    }
+
+    // sizes from L1 resident up to RAM resident, x4 steps
+    std::vector<size_t> sizes() const {
+        std::vector<size_t> out;
+        for (size_t n = opt.min_size; n <= opt.max_size; n *= 4) out.push_back(n);
+        return out;
+    }
+};
+
+/*
+    Timing
+*/
+
+// sink for computed values, so the optimizer cannot drop benchmarked work
+extern volatile uint64_t sink;
+
+template <class V>
+inline void keep(const V& v) {
+    sink = sink + (uint64_t)v;
+}
+
+// Times fn() opt.repeats times, setup() runs untimed before every run,
+// reports the best run
+template <class Setup, class Fn>
+inline void run(Context& ctx, const std::string& suite, const std::string& name, const std::string& impl, const std::string& dist,
+                double hit, size_t size, size_t ops, Setup setup, Fn fn) {
+    double best = 1e300;
+    for (int r = 0; r < ctx.opt.repeats; r++) {
+        setup();
+        auto beg = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - beg).count();
+        if (ns < best) best = ns;
+    }
+    ctx.results.push_back({ suite, name, impl, dist, hit, size, ops, best / (double)(ops ? ops : 1), "ns_per_op" });
+}
+
+// Reports a measured non-timing value (e.g. hash quality)
+inline void report(Context& ctx, const std::string& suite, const std::string& name, const std::string& impl, const std::string& dist,
+                   size_t size, size_t ops, double value, const std::string& unit) {
+    ctx.results.push_back({ suite, name, impl, dist, -1, size, ops, value, unit });
+}
+
+/*
+    Data generation
+*/
+
+// splitmix64, deterministic across runs and platforms
+struct Rng {
+    uint64_t state;
+
+    explicit Rng(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // uniform in [0, n)
+    size_t below(size_t n) {
+        return (size_t)(((unsigned __int128)next() * n) >> 64);
+    }
+
+    double unit() {
+        return (double)(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+// Zipf distributed ranks in [0, n), rank 0 the most frequent
+// Gray et al. "Quickly Generating Billion-Record Synthetic Databases", O(1) per sample
+struct Zipf {
+    size_t n;
+    double theta, alpha, zetan, eta;
+
+    Zipf(size_t n_, double theta_) : n(n_), theta(theta_) {
+        double zeta2 = 0;
+        zetan = 0;
+        for (size_t i = 1; i <= n; i++) {
+            zetan += 1.0 / std::pow((double)i, theta);
+            if (i == 2) zeta2 = zetan;
+        }
+        if (n < 2) zeta2 = zetan;
+        alpha = 1.0 / (1.0 - theta);
+        eta   = (1.0 - std::pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+
+    size_t operator()(Rng& rng) const {
+        double u  = rng.unit();
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + std::pow(0.5, theta)) return n > 1 ? 1 : 0;
+        size_t r = (size_t)((double)n * std::pow(eta * u - eta + 1.0, alpha));
+        return r < n ? r : n - 1;
+    }
+};
+
+// n indices into [0, n), uniform or zipf (theta 0.99)
+inline std::vector<size_t> indices(size_t n, size_t count, bool zipf, uint64_t seed) {
+    Rng rng(seed);
+    std::vector<size_t> out(count);
+    if (zipf) {
+        Zipf z(n, 0.99);
+        for (auto& i : out) i = z(rng);
+    }
+    else {
+        for (auto& i : out) i = rng.below(n);
+    }
+    return out;
+}
+
+// n distinct random 64-bit keys
+inline std::vector<uint64_t> distinct_keys(size_t n, uint64_t seed) {
+    Rng rng(seed);
+    std::vector<uint64_t> out(n);
+    // splitmix64 output function is a bijection, so distinct counters give distinct keys
+    for (size_t i = 0; i < n; i++) out[i] = rng.next();
+    return out;
+}
+
+// 64-bit finalizer (murmur3 fmix64), shared by riff and std maps so only the tables differ
+inline size_t mix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xFF51AFD7ED558CCDull;
+    k ^= k >> 33;
+    k *= 0xC4CEB9FE1A85EC53ull;
+    k ^= k >> 33;
+    return (size_t)k;
+}
+
+/*
+    Suites
+*/
+
+void containers(Context& ctx);
+void algorithms(Context& ctx);
+void hashes(Context& ctx);
+
+} // namespace bench
@@ -0,0 +1,796 @@
+/*
+    Containers - dyarr, queue, dlist, hhmap (C macros as riff, riff.hpp templates as riff++)
+    against std::vector, std::deque, std::list, std::unordered_map
+    slotmap against dlist node handles (riff_dlist) and std::list iterators
+    lru against hhmap of dlist nodes (riff_hhmap_dlist) and std::unordered_map of std::list iterators
+    mring spans against element-wise queue (riff_queue) and std::deque
+    bloom in front of hhmap (one by one and batched) against plain hhmap and std::unordered_map
+*/
+
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <unordered_map>
+
+static size_t u64_hash(const uint64_t* k)                { return bench::mix64(*k); }
+static int    u64_equal(const uint64_t* a, const uint64_t* b) { return *a == *b; }
+
+#define T u64, uint64_t,
+#define A malloc, realloc, free
+#include "riff/dynamic_array.h"
+
+#define T u64, uint64_t,
+#define A malloc, realloc, free
+#include "riff/queue.h"
+
+#define T u64, uint64_t,
+#define A malloc, realloc, free
+#include "riff/doubly_linked_list.h"
+
+#define T u64, uint64_t, , uint64_t, , u64_hash, u64_equal
+#define A malloc, realloc, free
+#include "riff/hashmap.h"
+
+#define T u64, uint64_t,
+#define A malloc, realloc, free
+#include "riff/slot_map.h"
+
+#define T u64, uint64_t, , uint64_t, , u64_hash, u64_equal
+#define A malloc, realloc, free
+#include "riff/lru_cache.h"
+
+#define T u64, uint64_t,
+#include "riff/mirrored_ring.h"
+
+#define T u64, uint64_t, u64_hash, u64, uint64_t
+#define A malloc, realloc, free
+#include "riff/bloom_filter.h"
+
+// the usual hand-rolled LRU, key -> list node, list of entries in recency order
+struct kv_entry {
+    uint64_t key;
+    uint64_t value;
+};
+
+#define T kv, kv_entry,
+#define A malloc, realloc, free
+#include "riff/doubly_linked_list.h"
+
+typedef dlist_node(kv)* kv_node;
+
+#define T u64_node, uint64_t, , kv_node, , u64_hash, u64_equal
+#define A malloc, realloc, free
+#include "riff/hashmap.h"
+
+#include "riff/riff.hpp"
+
+namespace bench {
+
+namespace {
+
+struct StdHash {
+    size_t operator()(uint64_t k) const { return mix64(k); }
+};
+
+using StdMap = std::unordered_map<uint64_t, uint64_t, StdHash>;
+using CppMap = riff::hhmap<uint64_t, uint64_t, StdHash>;
+
+// operations per timed run for steady state workloads, so small sizes are still measurable
+size_t churn_ops(size_t n) {
+    return n < (size_t(1) << 16) ? (size_t(1) << 16) : n;
+}
+
+const char* dist_name(bool zipf) {
+    return zipf ? "zipf" : "uniform";
+}
+
+void bench_dyarr(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        dyarr(u64) arr;
+        dyarr_zero(u64)(&arr);
+        riff::dyarr<uint64_t> cpp;
+        std::vector<uint64_t> vec;
+
+        run(ctx, "dyarr", "push", "riff", "seq", -1, n, n,
+            [&] { dyarr_destroy(u64)(&arr); },
+            [&] { for (size_t i = 0; i < n; i++) dyarr_push(u64)(&arr, i); });
+        run(ctx, "dyarr", "push", "riff++", "seq", -1, n, n,
+            [&] { cpp.destroy(); },
+            [&] { for (size_t i = 0; i < n; i++) cpp.push(i); });
+        run(ctx, "dyarr", "push", "std", "seq", -1, n, n,
+            [&] { vec = std::vector<uint64_t>(); },
+            [&] { for (size_t i = 0; i < n; i++) vec.push_back(i); });
+
+        run(ctx, "dyarr", "iterate", "riff", "seq", -1, n, n,
+            [] {},
+            [&] {
+                const uint64_t* data = dyarr_const_access(u64)(&arr);
+                uint64_t sum = 0;
+                for (size_t i = 0; i < dyarr_size(u64)(&arr); i++) sum += data[i];
+                keep(sum);
+            });
+        run(ctx, "dyarr", "iterate", "riff++", "seq", -1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (uint64_t v : cpp) sum += v;
+                keep(sum);
+            });
+        run(ctx, "dyarr", "iterate", "std", "seq", -1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (uint64_t v : vec) sum += v;
+                keep(sum);
+            });
+
+        run(ctx, "dyarr", "pop", "riff", "seq", -1, n, n,
+            [&] { dyarr_clear(u64)(&arr); for (size_t i = 0; i < n; i++) dyarr_push(u64)(&arr, i); },
+            [&] {
+                uint64_t sum = 0, v = 0;
+                while (dyarr_pop(u64)(&arr, &v)) sum += v;
+                keep(sum);
+            });
+        run(ctx, "dyarr", "pop", "riff++", "seq", -1, n, n,
+            [&] { cpp.clear(); for (size_t i = 0; i < n; i++) cpp.push(i); },
+            [&] {
+                uint64_t sum = 0, v = 0;
+                while (cpp.pop(&v)) sum += v;
+                keep(sum);
+            });
+        run(ctx, "dyarr", "pop", "std", "seq", -1, n, n,
+            [&] { vec.clear(); for (size_t i = 0; i < n; i++) vec.push_back(i); },
+            [&] {
+                uint64_t sum = 0;
+                while (!vec.empty()) { sum += vec.back(); vec.pop_back(); }
+                keep(sum);
+            });
+
+        dyarr_destroy(u64)(&arr);
+    }
+}
+
+void bench_queue(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        queue(u64) q;
+        queue_zero(u64)(&q);
+        riff::queue<uint64_t> cpp;
+        std::deque<uint64_t> dq;
+
+        // fill then drain, ops = pushes + pops
+        run(ctx, "queue", "push_pop", "riff", "seq", -1, n, 2 * n,
+            [&] { queue_destroy(u64)(&q); },
+            [&] {
+                uint64_t sum = 0, v = 0;
+                for (size_t i = 0; i < n; i++) queue_push(u64)(&q, i);
+                while (queue_pop(u64)(&q, &v)) sum += v;
+                keep(sum);
+            });
+        run(ctx, "queue", "push_pop", "riff++", "seq", -1, n, 2 * n,
+            [&] { cpp.destroy(); },
+            [&] {
+                uint64_t sum = 0, v = 0;
+                for (size_t i = 0; i < n; i++) cpp.push(i);
+                while (cpp.pop(&v)) sum += v;
+                keep(sum);
+            });
+        run(ctx, "queue", "push_pop", "std", "seq", -1, n, 2 * n,
+            [&] { dq = std::deque<uint64_t>(); },
+            [&] {
+                uint64_t sum = 0;
+                for (size_t i = 0; i < n; i++) dq.push_back(i);
+                while (!dq.empty()) { sum += dq.front(); dq.pop_front(); }
+                keep(sum);
+            });
+
+        // steady state of n elements, one op = push + pop
+        size_t ops = churn_ops(n);
+        run(ctx, "queue", "churn", "riff", "seq", -1, n, ops,
+            [&] { queue_destroy(u64)(&q); for (size_t i = 0; i < n; i++) queue_push(u64)(&q, i); },
+            [&] {
+                uint64_t sum = 0, v = 0;
+                for (size_t i = 0; i < ops; i++) {
+                    queue_pop(u64)(&q, &v);
+                    sum += v;
+                    queue_push(u64)(&q, v + 1);
+                }
+                keep(sum);
+            });
+        run(ctx, "queue", "churn", "riff++", "seq", -1, n, ops,
+            [&] { cpp.destroy(); for (size_t i = 0; i < n; i++) cpp.push(i); },
+            [&] {
+                uint64_t sum = 0, v = 0;
+                for (size_t i = 0; i < ops; i++) {
+                    cpp.pop(&v);
+                    sum += v;
+                    cpp.push(v + 1);
+                }
+                keep(sum);
+            });
+        run(ctx, "queue", "churn", "std", "seq", -1, n, ops,
+            [&] { dq.clear(); for (size_t i = 0; i < n; i++) dq.push_back(i); },
+            [&] {
+                uint64_t sum = 0;
+                for (size_t i = 0; i < ops; i++) {
+                    uint64_t v = dq.front();
+                    dq.pop_front();
+                    sum += v;
+                    dq.push_back(v + 1);
+                }
+                keep(sum);
+            });
+
+        queue_destroy(u64)(&q);
+    }
+}
+
+void bench_dlist(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        dlist(u64) l;
+        dlist_zero(u64)(&l);
+        riff::dlist<uint64_t> cpp;
+        std::list<uint64_t> sl;
+
+        run(ctx, "dlist", "push", "riff", "seq", -1, n, n,
+            [&] { dlist_destroy(u64)(&l); },
+            [&] { for (size_t i = 0; i < n; i++) dlist_push_before(u64)(&l, NULL, i); });
+        run(ctx, "dlist", "push", "riff++", "seq", -1, n, n,
+            [&] { cpp.destroy(); },
+            [&] { for (size_t i = 0; i < n; i++) cpp.push_before(nullptr, i); });
+        run(ctx, "dlist", "push", "std", "seq", -1, n, n,
+            [&] { sl.clear(); },
+            [&] { for (size_t i = 0; i < n; i++) sl.push_back(i); });
+
+        run(ctx, "dlist", "iterate", "riff", "seq", -1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (dlist_node(u64)* it = dlist_first(u64)(&l); it; it = dlist_next(u64)(it)) sum += *dlist_access(u64)(it);
+                keep(sum);
+            });
+        run(ctx, "dlist", "iterate", "riff++", "seq", -1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (uint64_t v : cpp) sum += v;
+                keep(sum);
+            });
+        run(ctx, "dlist", "iterate", "std", "seq", -1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (uint64_t v : sl) sum += v;
+                keep(sum);
+            });
+
+        // erase node picked by the distribution, reinsert at the back
+        size_t ops = churn_ops(n);
+        for (bool zipf : { false, true }) {
+            std::vector<size_t> picks = indices(n, ops, zipf, 17);
+
+            std::vector<dlist_node(u64)*> handles(n);
+            run(ctx, "dlist", "churn", "riff", dist_name(zipf), -1, n, ops,
+                [&] {
+                    dlist_destroy(u64)(&l);
+                    for (size_t i = 0; i < n; i++) handles[i] = dlist_push_before(u64)(&l, NULL, i);
+                },
+                [&] {
+                    for (size_t i = 0; i < ops; i++) {
+                        size_t   p = picks[i];
+                        uint64_t v = 0;
+                        dlist_pop(u64)(&l, handles[p], &v);
+                        handles[p] = dlist_push_before(u64)(&l, NULL, v + 1);
+                    }
+                });
+
+            std::vector<std::list<uint64_t>::iterator> iters(n);
+            run(ctx, "dlist", "churn", "std", dist_name(zipf), -1, n, ops,
+                [&] {
+                    sl.clear();
+                    for (size_t i = 0; i < n; i++) iters[i] = sl.insert(sl.end(), i);
+                },
+                [&] {
+                    for (size_t i = 0; i < ops; i++) {
+                        size_t   p = picks[i];
+                        uint64_t v = *iters[p];
+                        sl.erase(iters[p]);
+                        iters[p] = sl.insert(sl.end(), v + 1);
+                    }
+                });
+        }
+
+        dlist_destroy(u64)(&l);
+    }
+}
+
+void bench_hhmap(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        // first n keys are inserted, the other n are guaranteed misses
+        std::vector<uint64_t> keys = distinct_keys(2 * n, 42);
+
+        hhmap(u64) m;
+        hhmap_zero(u64)(&m);
+        CppMap cpp;
+        StdMap sm;
+
+        run(ctx, "hhmap", "insert", "riff", "uniform", -1, n, n,
+            [&] { hhmap_destroy(u64)(&m); },
+            [&] { for (size_t i = 0; i < n; i++) hhmap_push(u64)(&m, keys[i], i); });
+        run(ctx, "hhmap", "insert", "riff++", "uniform", -1, n, n,
+            [&] { cpp.destroy(); },
+            [&] { for (size_t i = 0; i < n; i++) cpp.push(keys[i], i); });
+        run(ctx, "hhmap", "insert", "std", "uniform", -1, n, n,
+            [&] { sm = StdMap(); },
+            [&] { for (size_t i = 0; i < n; i++) sm.emplace(keys[i], i); });
+
+        // lookups, queries picked by the distribution among hits or misses
+        for (bool zipf : { false, true }) {
+            for (double hit : { 1.0, 0.5, 0.0 }) {
+                std::vector<size_t> picks = indices(n, n, zipf, 7);
+                Rng rng(99);
+                std::vector<uint64_t> queries(n);
+                for (size_t i = 0; i < n; i++) queries[i] = keys[picks[i] + (rng.unit() < hit ? 0 : n)];
+
+                run(ctx, "hhmap", "find", "riff", dist_name(zipf), hit, n, n,
+                    [] {},
+                    [&] {
+                        uint64_t sum = 0;
+                        uint64_t* v;
+                        for (uint64_t q : queries) if (hhmap_find(u64)(&m, q, NULL, &v)) sum += *v;
+                        keep(sum);
+                    });
+                run(ctx, "hhmap", "find", "riff++", dist_name(zipf), hit, n, n,
+                    [] {},
+                    [&] {
+                        uint64_t sum = 0;
+                        for (uint64_t q : queries) if (const uint64_t* v = cpp.find(q)) sum += *v;
+                        keep(sum);
+                    });
+                run(ctx, "hhmap", "find", "std", dist_name(zipf), hit, n, n,
+                    [] {},
+                    [&] {
+                        uint64_t sum = 0;
+                        for (uint64_t q : queries) {
+                            auto it = sm.find(q);
+                            if (it != sm.end()) sum += it->second;
+                        }
+                        keep(sum);
+                    });
+            }
+        }
+
+        // erase a key picked by the distribution, insert a fresh one in its place
+        size_t ops = churn_ops(n);
+        for (bool zipf : { false, true }) {
+            std::vector<size_t>   picks = indices(n, ops, zipf, 23);
+            std::vector<uint64_t> fresh = distinct_keys(ops, 4242);
+            std::vector<uint64_t> live;
+
+            run(ctx, "hhmap", "churn", "riff", dist_name(zipf), -1, n, ops,
+                [&] {
+                    hhmap_destroy(u64)(&m);
+                    live.assign(keys.begin(), keys.begin() + n);
+                    for (size_t i = 0; i < n; i++) hhmap_push(u64)(&m, live[i], i);
+                },
+                [&] {
+                    for (size_t i = 0; i < ops; i++) {
+                        size_t p = picks[i];
+                        const uint64_t* inner = nullptr;
+                        if (hhmap_find(u64)(&m, live[p], &inner, NULL)) hhmap_pop(u64)(&m, inner, NULL);
+                        live[p] = fresh[i];
+                        hhmap_push(u64)(&m, live[p], i);
+                    }
+                });
+            run(ctx, "hhmap", "churn", "riff++", dist_name(zipf), -1, n, ops,
+                [&] {
+                    cpp.destroy();
+                    live.assign(keys.begin(), keys.begin() + n);
+                    for (size_t i = 0; i < n; i++) cpp.push(live[i], i);
+                },
+                [&] {
+                    for (size_t i = 0; i < ops; i++) {
+                        size_t p = picks[i];
+                        cpp.pop(live[p]);
+                        live[p] = fresh[i];
+                        cpp.push(live[p], i);
+                    }
+                });
+            run(ctx, "hhmap", "churn", "std", dist_name(zipf), -1, n, ops,
+                [&] {
+                    sm = StdMap();
+                    live.assign(keys.begin(), keys.begin() + n);
+                    for (size_t i = 0; i < n; i++) sm.emplace(live[i], i);
+                },
+                [&] {
+                    for (size_t i = 0; i < ops; i++) {
+                        size_t p = picks[i];
+                        sm.erase(live[p]);
+                        live[p] = fresh[i];
+                        sm.emplace(live[p], i);
+                    }
+                });
+        }
+
+        hhmap_destroy(u64)(&m);
+    }
+}
+
+void bench_slotmap(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        slotmap(u64) sm;
+        slotmap_zero(u64)(&sm);
+        std::vector<riff_slotmap_handle> handles(n);
+
+        dlist(u64) l;
+        dlist_zero(u64)(&l);
+        std::vector<dlist_node(u64)*> nodes(n);
+
+        std::list<uint64_t> sl;
+        std::vector<std::list<uint64_t>::iterator> iters(n);
+
+        auto fill = [&] {
+            slotmap_destroy(u64)(&sm);
+            dlist_destroy(u64)(&l);
+            sl.clear();
+            for (size_t i = 0; i < n; i++) {
+                slotmap_insert(u64)(&sm, i, &handles[i]);
+                nodes[i] = dlist_push_before(u64)(&l, NULL, i);
+                iters[i] = sl.insert(sl.end(), i);
+            }
+        };
+
+        // erase element picked by the distribution, insert a new one in its place, as entities die and spawn
+        size_t ops = churn_ops(n);
+        for (bool zipf : { false, true }) {
+            std::vector<size_t> picks = indices(n, ops, zipf, 31);
+
+            run(ctx, "slotmap", "churn", "riff", dist_name(zipf), -1, n, ops, fill,
+                [&] {
+                    for (size_t i = 0; i < ops; i++) {
+                        size_t   p = picks[i];
+                        uint64_t v = 0;
+                        slotmap_erase(u64)(&sm, handles[p], &v);
+                        slotmap_insert(u64)(&sm, v + 1, &handles[p]);
+                    }
+                });
+            run(ctx, "slotmap", "churn", "riff_dlist", dist_name(zipf), -1, n, ops, fill,
+                [&] {
+                    for (size_t i = 0; i < ops; i++) {
+                        size_t   p = picks[i];
+                        uint64_t v = 0;
+                        dlist_pop(u64)(&l, nodes[p], &v);
+                        nodes[p] = dlist_push_before(u64)(&l, NULL, v + 1);
+                    }
+                });
+            run(ctx, "slotmap", "churn", "std", dist_name(zipf), -1, n, ops, fill,
+                [&] {
+                    for (size_t i = 0; i < ops; i++) {
+                        size_t   p = picks[i];
+                        uint64_t v = *iters[p];
+                        sl.erase(iters[p]);
+                        iters[p] = sl.insert(sl.end(), v + 1);
+                    }
+                });
+        }
+
+        // after churn, the per tick pass over all elements
+        run(ctx, "slotmap", "iterate", "riff", "seq", -1, n, n,
+            [] {},
+            [&] {
+                const uint64_t* data = slotmap_const_access(u64)(&sm);
+                uint64_t sum = 0;
+                for (size_t i = 0; i < slotmap_size(u64)(&sm); i++) sum += data[i];
+                keep(sum);
+            });
+        run(ctx, "slotmap", "iterate", "riff_dlist", "seq", -1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (dlist_node(u64)* it = dlist_first(u64)(&l); it; it = dlist_next(u64)(it)) sum += *dlist_access(u64)(it);
+                keep(sum);
+            });
+        run(ctx, "slotmap", "iterate", "std", "seq", -1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (uint64_t v : sl) sum += v;
+                keep(sum);
+            });
+
+        // access by handle in random order
+        std::vector<size_t> picks = indices(n, n, false, 37);
+        run(ctx, "slotmap", "get", "riff", "uniform", 1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (size_t p : picks) sum += *slotmap_get(u64)(&sm, handles[p]);
+                keep(sum);
+            });
+        run(ctx, "slotmap", "get", "riff_dlist", "uniform", 1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (size_t p : picks) sum += *dlist_access(u64)(nodes[p]);
+                keep(sum);
+            });
+        run(ctx, "slotmap", "get", "std", "uniform", 1, n, n,
+            [] {},
+            [&] {
+                uint64_t sum = 0;
+                for (size_t p : picks) sum += *iters[p];
+                keep(sum);
+            });
+
+        slotmap_destroy(u64)(&sm);
+        dlist_destroy(u64)(&l);
+    }
+}
+
+void bench_lru(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        // capacity n over 8n keys, zipf trace, get and put on miss
+        size_t universe = n * 8;
+        size_t ops      = churn_ops(n);
+        std::vector<uint64_t> keys  = distinct_keys(universe, 53);
+        std::vector<size_t>   warm  = indices(universe, n, true, 59);
+        std::vector<size_t>   picks = indices(universe, ops, true, 61);
+
+        lru(u64) c;
+        lru_zero(u64)(&c);
+
+        hhmap(u64_node) m;
+        hhmap_zero(u64_node)(&m);
+        dlist(kv) l;
+        dlist_zero(kv)(&l);
+
+        using StdList = std::list<std::pair<uint64_t, uint64_t>>;
+        StdList sl;
+        std::unordered_map<uint64_t, StdList::iterator, StdHash> sm;
+
+        uint64_t sum = 0;
+
+        auto riff_access = [&](uint64_t k) {
+            uint64_t* v = lru_get(u64)(&c, k);
+            if (v) { sum += *v; return 1; }
+            lru_put(u64)(&c, k, k);
+            return 0;
+        };
+        auto hand_access = [&](uint64_t k) {
+            kv_node* node;
+            if (hhmap_find(u64_node)(&m, k, NULL, &node)) {
+                kv_entry e;
+                dlist_pop(kv)(&l, *node, &e);
+                *node = dlist_push_after(kv)(&l, NULL, e);
+                sum += e.value;
+                return 1;
+            }
+            if (dlist_size(kv)(&l) == n) {
+                kv_node         last = dlist_last(kv)(&l);
+                const uint64_t* inner = nullptr;
+                hhmap_find(u64_node)(&m, dlist_access(kv)(last)->key, &inner, NULL);
+                hhmap_pop(u64_node)(&m, inner, NULL);
+                dlist_pop(kv)(&l, last, NULL);
+            }
+            hhmap_push(u64_node)(&m, k, dlist_push_after(kv)(&l, NULL, kv_entry{ k, k }));
+            return 0;
+        };
+        auto std_access = [&](uint64_t k) {
+            auto it = sm.find(k);
+            if (it != sm.end()) {
+                sl.splice(sl.begin(), sl, it->second);
+                sum += it->second->second;
+                return 1;
+            }
+            if (sl.size() == n) {
+                sm.erase(sl.back().first);
+                sl.pop_back();
+            }
+            sl.emplace_front(k, k);
+            sm.emplace(k, sl.begin());
+            return 0;
+        };
+
+        // every impl is exact LRU, so they share the hit ratio
+        size_t hits = 0;
+        lru_set_capacity(u64)(&c, n);
+        for (size_t p : warm)  riff_access(keys[p]);
+        for (size_t p : picks) hits += riff_access(keys[p]);
+        double hit = (double)hits / (double)ops;
+
+        run(ctx, "lru", "get_put", "riff", "zipf", hit, n, ops,
+            [&] {
+                lru_clear(u64)(&c);
+                for (size_t p : warm) riff_access(keys[p]);
+            },
+            [&] { for (size_t p : picks) riff_access(keys[p]); });
+        run(ctx, "lru", "get_put", "riff_hhmap_dlist", "zipf", hit, n, ops,
+            [&] {
+                hhmap_clear(u64_node)(&m);
+                dlist_clear(kv)(&l);
+                for (size_t p : warm) hand_access(keys[p]);
+            },
+            [&] { for (size_t p : picks) hand_access(keys[p]); });
+        run(ctx, "lru", "get_put", "std", "zipf", hit, n, ops,
+            [&] {
+                sm.clear();
+                sl.clear();
+                for (size_t p : warm) std_access(keys[p]);
+            },
+            [&] { for (size_t p : picks) std_access(keys[p]); });
+        keep(sum);
+
+        lru_destroy(u64)(&c);
+        hhmap_destroy(u64_node)(&m);
+        dlist_destroy(kv)(&l);
+    }
+}
+
+void bench_mring(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        // producer writes records of 1 - 256 elements while they fit, consumer takes 1 - 256 of what is there
+        size_t ops = churn_ops(n) * 4;
+        Rng    rng(67);
+        std::vector<size_t> lens(4096);
+        for (auto& len : lens) len = 1 + rng.below(256);
+
+        mring(u64) r;
+        mring_zero(u64)(&r);
+        mring_reserve(u64)(&r, n);
+        size_t capc = mring_capacity(u64)(&r);
+
+        queue(u64) q;
+        queue_zero(u64)(&q);
+        std::deque<uint64_t> dq;
+
+        run(ctx, "mring", "stream", "riff", "seq", -1, n, ops,
+            [&] { mring_clear(u64)(&r); },
+            [&] {
+                uint64_t sum = 0;
+                size_t   written = 0, k = 0;
+                while (written < ops) {
+                    size_t want = lens[k++ & 4095];
+                    if (uint64_t* span = mring_reserve_write(u64)(&r, want)) {
+                        for (size_t i = 0; i < want; i++) span[i] = written + i;
+                        mring_commit_write(u64)(&r, want);
+                        written += want;
+                    }
+                    size_t    avail;
+                    uint64_t* data = mring_peek_read(u64)(&r, &avail);
+                    size_t    take = lens[k++ & 4095];
+                    if (take > avail) take = avail;
+                    for (size_t i = 0; i < take; i++) sum += data[i];
+                    mring_consume_read(u64)(&r, take);
+                }
+                keep(sum);
+            });
+        run(ctx, "mring", "stream", "riff_queue", "seq", -1, n, ops,
+            [&] { queue_destroy(u64)(&q); },
+            [&] {
+                uint64_t sum = 0;
+                size_t   written = 0, k = 0;
+                while (written < ops) {
+                    size_t want = lens[k++ & 4095];
+                    if (queue_size(u64)(&q) + want <= capc) {
+                        for (size_t i = 0; i < want; i++) queue_push(u64)(&q, written + i);
+                        written += want;
+                    }
+                    size_t take = lens[k++ & 4095];
+                    for (size_t i = 0; i < take && !queue_empty(u64)(&q); i++) {
+                        sum += *queue_top(u64)(&q);
+                        queue_pop(u64)(&q, NULL);
+                    }
+                }
+                keep(sum);
+            });
+        run(ctx, "mring", "stream", "std", "seq", -1, n, ops,
+            [&] { dq = std::deque<uint64_t>(); },
+            [&] {
+                uint64_t sum = 0;
+                size_t   written = 0, k = 0;
+                while (written < ops) {
+                    size_t want = lens[k++ & 4095];
+                    if (dq.size() + want <= capc) {
+                        for (size_t i = 0; i < want; i++) dq.push_back(written + i);
+                        written += want;
+                    }
+                    size_t take = lens[k++ & 4095];
+                    for (size_t i = 0; i < take && !dq.empty(); i++) {
+                        sum += dq.front();
+                        dq.pop_front();
+                    }
+                }
+                keep(sum);
+            });
+
+        mring_destroy(u64)(&r);
+        queue_destroy(u64)(&q);
+    }
+}
+
+void bench_bloom(Context& ctx) {
+    for (size_t n : ctx.sizes()) {
+        // first n keys are inserted, the other n are guaranteed misses
+        std::vector<uint64_t> keys = distinct_keys(2 * n, 42);
+
+        bloom(u64) f;
+        bloom_zero(u64)(&f);
+        bloom_reset(u64)(&f, n, 0.01);
+        hhmap(u64) m;
+        hhmap_zero(u64)(&m);
+        StdMap sm;
+        for (size_t i = 0; i < n; i++) {
+            bloom_hhmap_push(u64)(&f, &m, keys[i], i);
+            sm.emplace(keys[i], i);
+        }
+
+        size_t fp = 0;
+        for (size_t i = n; i < 2 * n; i++) fp += bloom_contains(u64)(&f, keys[i]) != 0;
+        report(ctx, "bloom", "false_positive", "riff", "uniform", n, n, (double)fp / (double)n, "rate");
+        report(ctx, "bloom", "memory", "riff", "uniform", n, n, (double)bloom_bytes(u64)(&f) * 8 / (double)n, "bits_per_key");
+
+        // mostly missing lookups, as ahead of a cache or a join
+        for (double hit : { 0.1, 0.5 }) {
+            std::vector<size_t> picks = indices(n, n, false, 71);
+            Rng rng(73);
+            std::vector<uint64_t> queries(n);
+            for (size_t i = 0; i < n; i++) queries[i] = keys[picks[i] + (rng.unit() < hit ? 0 : n)];
+            std::vector<unsigned char> maybe(n);
+
+            run(ctx, "bloom", "find", "riff", "uniform", hit, n, n,
+                [] {},
+                [&] {
+                    uint64_t sum = 0;
+                    uint64_t* v;
+                    for (uint64_t q : queries) if (bloom_hhmap_find(u64)(&f, &m, q, NULL, &v)) sum += *v;
+                    keep(sum);
+                });
+            run(ctx, "bloom", "find", "riff_batch", "uniform", hit, n, n,
+                [] {},
+                [&] {
+                    uint64_t sum = 0;
+                    uint64_t* v;
+                    bloom_contains_many(u64)(&f, queries.data(), n, maybe.data());
+                    for (size_t i = 0; i < n; i++) if (maybe[i] && hhmap_find(u64)(&m, queries[i], NULL, &v)) sum += *v;
+                    keep(sum);
+                });
+            run(ctx, "bloom", "find", "riff_hhmap", "uniform", hit, n, n,
+                [] {},
+                [&] {
+                    uint64_t sum = 0;
+                    uint64_t* v;
+                    for (uint64_t q : queries) if (hhmap_find(u64)(&m, q, NULL, &v)) sum += *v;
+                    keep(sum);
+                });
+            run(ctx, "bloom", "find", "std", "uniform", hit, n, n,
+                [] {},
+                [&] {
+                    uint64_t sum = 0;
+                    for (uint64_t q : queries) {
+                        auto it = sm.find(q);
+                        if (it != sm.end()) sum += it->second;
+                    }
+                    keep(sum);
+                });
+        }
+
+        bloom_destroy(u64)(&f);
+        hhmap_destroy(u64)(&m);
+    }
+}
+
+} // namespace
+
+void containers(Context& ctx) {
+    if (ctx.enabled("dyarr"))   bench_dyarr(ctx);
+    if (ctx.enabled("queue"))   bench_queue(ctx);
+    if (ctx.enabled("dlist"))   bench_dlist(ctx);
+    if (ctx.enabled("hhmap"))   bench_hhmap(ctx);
+    if (ctx.enabled("slotmap")) bench_slotmap(ctx);
+    if (ctx.enabled("lru"))     bench_lru(ctx);
+    if (ctx.enabled("mring"))   bench_mring(ctx);
+    if (ctx.enabled("bloom"))   bench_bloom(ctx);
+}
+
+} // namespace bench
@@ -0,0 +1,181 @@
+/*
+    Hashes - riff/hash.h against identity, FNV-1a, djb2 and std::hash
+    Throughput (ns per hash) and distribution quality:
+        avg_probe - mean linear probing displacement in a power of two table at load 0.5 (slots)
+        avalanche - worst input / output bit pair flip bias, 0 ideal, 1 for bits that never change
+*/
+
+#include "bench.hpp"
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "riff/hash.h"
+
+namespace bench {
+
+namespace {
+
+uint64_t fnv1a(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < len; i++) h = (h ^ p[i]) * 0x100000001b3ull;
+    return h;
+}
+
+uint64_t djb2(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = 5381;
+    for (size_t i = 0; i < len; i++) h = h * 33 + p[i];
+    return h;
+}
+
+struct BytesHash {
+    const char* name;
+    uint64_t  (*fn)(const void*, size_t);
+};
+
+const BytesHash bytes_hashes[] = {
+    { "riff",  [](const void* d, size_t l) { return riff_hash_bytes(d, l, 0); } },
+    { "fnv1a", fnv1a },
+    { "djb2",  djb2 },
+    { "std",   [](const void* d, size_t l) { return (uint64_t)std::hash<std::string_view>()(std::string_view((const char*)d, l)); } },
+};
+
+struct IntHash {
+    const char* name;
+    uint64_t  (*fn)(uint64_t);
+};
+
+const IntHash int_hashes[] = {
+    { "riff_mix64",  riff_mix64 },
+    { "riff_seeded", [](uint64_t x) { return riff_mix64_seeded(x, 0x243f6a8885a308d3ull); } },
+    { "std",         [](uint64_t x) { return (uint64_t)std::hash<uint64_t>()(x); } },
+};
+
+// mean displacement of linear probing insertion of hashes into a table of the next power of two >= 2 * count
+double avg_probe(const std::vector<uint64_t>& hashes) {
+    size_t capc = 1;
+    while (capc < 2 * hashes.size()) capc *= 2;
+    std::vector<char> used(capc, 0);
+
+    size_t total = 0;
+    for (uint64_t h : hashes) {
+        size_t pos = (size_t)h & (capc - 1);
+        while (used[pos]) {
+            pos = (pos + 1) & (capc - 1);
+            total++;
+        }
+        used[pos] = 1;
+    }
+    return (double)total / (double)hashes.size();
+}
+
+// worst |P(output bit j flips when input bit i flips) - 0.5| * 2 over all i, j
+template <class Hash>
+double avalanche(size_t in_bytes, size_t samples, Hash hash) {
+    size_t in_bits = in_bytes * 8;
+    std::vector<size_t> flips(in_bits * 64, 0);
+    Rng rng(77);
+    std::vector<uint8_t> in(in_bytes);
+
+    for (size_t s = 0; s < samples; s++) {
+        for (auto& b : in) b = (uint8_t)rng.next();
+        uint64_t base = hash(in.data(), in_bytes);
+        for (size_t i = 0; i < in_bits; i++) {
+            in[i / 8] ^= (uint8_t)(1u << (i % 8));
+            uint64_t diff = base ^ hash(in.data(), in_bytes);
+            in[i / 8] ^= (uint8_t)(1u << (i % 8));
+            for (size_t j = 0; j < 64; j++) flips[i * 64 + j] += (diff >> j) & 1;
+        }
+    }
+
+    double worst = 0;
+    for (size_t f : flips) {
+        double bias = std::fabs((double)f / (double)samples - 0.5) * 2;
+        if (bias > worst) worst = bias;
+    }
+    return worst;
+}
+
+void bench_throughput(Context& ctx) {
+    // byte strings of given length, taken from a random buffer at sliding offsets
+    std::vector<uint8_t> buf(size_t(1) << 20);
+    Rng rng(1);
+    for (auto& b : buf) b = (uint8_t)rng.next();
+
+    for (size_t len : { 4, 8, 16, 32, 64, 256, 4096 }) {
+        size_t ops = (size_t(1) << 24) / (len + 16);
+        for (const BytesHash& h : bytes_hashes) {
+            run(ctx, "hash", "bytes", h.name, "uniform", -1, len, ops, [] {},
+                [&] {
+                    uint64_t acc = 0;
+                    size_t   off = 0;
+                    for (size_t i = 0; i < ops; i++) {
+                        acc ^= h.fn(buf.data() + off, len);
+                        off = (off + 64) & (buf.size() - 4096 - 1);
+                    }
+                    keep(acc);
+                });
+        }
+    }
+
+    std::vector<uint64_t> ints = distinct_keys(size_t(1) << 20, 3);
+    for (const IntHash& h : int_hashes) {
+        run(ctx, "hash", "u64", h.name, "uniform", -1, 8, ints.size(), [] {},
+            [&] {
+                uint64_t acc = 0;
+                for (uint64_t x : ints) acc += h.fn(x);
+                keep(acc);
+            });
+    }
+}
+
+void bench_quality(Context& ctx) {
+    const size_t n = size_t(1) << 16;
+
+    // integer key sets: sequential and strided (like aligned addresses), the usual identity hash traps
+    struct KeySet { const char* name; uint64_t step; };
+    for (KeySet ks : { KeySet{ "seq", 1 }, KeySet{ "stride4k", 4096 } }) {
+        for (const IntHash& h : int_hashes) {
+            std::vector<uint64_t> hashes(n);
+            for (size_t i = 0; i < n; i++) hashes[i] = h.fn(i * ks.step);
+            report(ctx, "hash", "avg_probe", h.name, ks.name, n, n, avg_probe(hashes), "slots");
+        }
+    }
+
+    // string keys "key_0", "key_1" ...
+    std::vector<std::string> strs(n);
+    for (size_t i = 0; i < n; i++) strs[i] = "key_" + std::to_string(i);
+    for (const BytesHash& h : bytes_hashes) {
+        std::vector<uint64_t> hashes(n);
+        for (size_t i = 0; i < n; i++) hashes[i] = h.fn(strs[i].data(), strs[i].size());
+        report(ctx, "hash", "avg_probe", h.name, "strings", n, n, avg_probe(hashes), "slots");
+    }
+
+    const size_t samples = 2000;
+    for (const IntHash& h : int_hashes) {
+        double bias = avalanche(8, samples, [&](const uint8_t* in, size_t) {
+            uint64_t x;
+            std::memcpy(&x, in, 8);
+            return h.fn(x);
+        });
+        report(ctx, "hash", "avalanche", h.name, "uniform", 8, samples, bias, "max_bias");
+    }
+    for (const BytesHash& h : bytes_hashes) {
+        double bias = avalanche(16, samples, [&](const uint8_t* in, size_t len) { return h.fn(in, len); });
+        report(ctx, "hash", "avalanche", h.name, "uniform", 16, samples, bias, "max_bias");
+    }
+}
+
+} // namespace
+
+void hashes(Context& ctx) {
+    if (!ctx.enabled("hash")) return;
+    bench_throughput(ctx);
+    bench_quality(ctx);
+}
+
+} // namespace bench
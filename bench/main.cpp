@@ -0,0 +1,76 @@
+/*
+    Riff benchmark runner
+
+    Usage: riff_bench [--format csv|json] [--filter SUITE] [--min-size N] [--max-size N]
+                      [--repeats N] [--quick]
+*/
+
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace bench {
+volatile uint64_t sink = 0;
+}
+
+static void print_csv(const bench::Context& ctx) {
+    std::printf("suite,bench,impl,dist,hit,size,ops,value,unit\n");
+    for (const auto& r : ctx.results) {
+        std::printf("%s,%s,%s,%s,%.2f,%zu,%zu,%.4f,%s\n",
+            r.suite.c_str(), r.bench.c_str(), r.impl.c_str(), r.dist.c_str(), r.hit, r.size, r.ops, r.value, r.unit.c_str());
+    }
+}
+
+static void print_json(const bench::Context& ctx) {
+    std::printf("[\n");
+    for (size_t i = 0; i < ctx.results.size(); i++) {
+        const auto& r = ctx.results[i];
+        std::printf("  {\"suite\": \"%s\", \"bench\": \"%s\", \"impl\": \"%s\", \"dist\": \"%s\", "
+                    "\"hit\": %.2f, \"size\": %zu, \"ops\": %zu, \"value\": %.4f, \"unit\": \"%s\"}%s\n",
+            r.suite.c_str(), r.bench.c_str(), r.impl.c_str(), r.dist.c_str(), r.hit, r.size, r.ops, r.value, r.unit.c_str(),
+            i + 1 < ctx.results.size() ? "," : "");
+    }
+    std::printf("]\n");
+}
+
+static void usage(const char* self) {
+    std::fprintf(stderr,
+        "usage: %s [--format csv|json] [--filter SUITE] [--min-size N] [--max-size N] [--repeats N] [--quick]\n"
+        "  --quick  sizes up to 64K elements, single run\n", self);
+}
+
+int main(int argc, char** argv) {
+    bench::Context ctx;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a   = argv[i];
+        const char* val = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if      (!std::strcmp(a, "--quick"))             { ctx.opt.max_size = size_t(1) << 16; ctx.opt.repeats = 1; }
+        else if (!std::strcmp(a, "--format")   && val)   { ctx.opt.format   = val; i++; }
+        else if (!std::strcmp(a, "--filter")   && val)   { ctx.opt.filter   = val; i++; }
+        else if (!std::strcmp(a, "--min-size") && val)   { ctx.opt.min_size = std::strtoull(val, nullptr, 10); i++; }
+        else if (!std::strcmp(a, "--max-size") && val)   { ctx.opt.max_size = std::strtoull(val, nullptr, 10); i++; }
+        else if (!std::strcmp(a, "--repeats")  && val)   { ctx.opt.repeats  = std::atoi(val); i++; }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (ctx.opt.format != "csv" && ctx.opt.format != "json") {
+        usage(argv[0]);
+        return 1;
+    }
+    if (ctx.opt.min_size == 0) ctx.opt.min_size = 1;
+    if (ctx.opt.repeats < 1)   ctx.opt.repeats  = 1;
+
+    bench::containers(ctx);
+    bench::algorithms(ctx);
+    bench::hashes(ctx);
+
+    if (ctx.opt.format == "json") print_json(ctx);
+    else                          print_csv(ctx);
+    return 0;
+}
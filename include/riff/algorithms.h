@@ -0,0 +1,417 @@
+/*
+    T macro pattern
+        [instance name], [stored type],
+        [less function - int(func)(const STORED* a, const STORED* b) (non-0 if a < b)],
+        [radix key function (opt) - uint64_t(func)(const STORED*)]
+
+    Algorithms work on plain buffers, for example the ones returned by dyarr_access()
+    The less / key functions are called directly, so they can be inlined - static inline functions
+    and function-like macros both work
+    The radix key must be order preserving: a < b implies key(a) <= key(b),
+    riff_radix_key_* helpers below convert common primitive types, use them through a macro
+    e.g. #define KEY_OF(p) riff_radix_key_f32((p)->x)
+    algo_radix_sort() is only defined when the radix key function is provided
+*/
+
+#include "generic.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Radix Keys
+*/
+
+#ifndef RIFF_ALGORITHMS_KEYS
+#define RIFF_ALGORITHMS_KEYS
+
+// Order preserving conversions of primitive types into unsigned radix keys
+// O(1)
+RIFF_API(uint64_t) riff_radix_key_u64(uint64_t v) { return v; }
+RIFF_API(uint64_t) riff_radix_key_u32(uint32_t v) { return v; }
+RIFF_API(uint64_t) riff_radix_key_i64(int64_t v)  { return (uint64_t)v ^ ((uint64_t)1 << 63); }
+RIFF_API(uint64_t) riff_radix_key_i32(int32_t v)  { return (uint32_t)v ^ (uint32_t)0x80000000u; }
+
+RIFF_API(uint64_t) riff_radix_key_f32(float v) {
+    uint32_t bits; memcpy(&bits, &v, sizeof(bits));
+    // negative -> flip everything, positive -> flip sign only
+    return bits ^ ((bits >> 31) ? (uint32_t)0xFFFFFFFFu : (uint32_t)0x80000000u);
+}
+
+RIFF_API(uint64_t) riff_radix_key_f64(double v) {
+    uint64_t bits; memcpy(&bits, &v, sizeof(bits));
+    return bits ^ ((bits >> 63) ? ~(uint64_t)0 : ((uint64_t)1 << 63));
+}
+
+#endif // RIFF_ALGORITHMS_KEYS
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE  RIFF_FIRST(T)
+#define STORED    RIFF_SECOND(T)
+#define LESS      RIFF_THIRD(T)
+#define RADIX_KEY RIFF_FOURTH(T, , )
+
+// below this size insertion sort beats partitioning
+#define SMALL_SORT 16
+
+// length of runs sorted with insertion sort before merging
+#define MERGE_RUN 32
+
+/*
+    Internals
+*/
+
+RIFF_API(void) RIFF_INST(algo_internal_swap, INSTANCE)(STORED* a, STORED* b) {
+    STORED tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+RIFF_API(void) RIFF_INST(algo_internal_insertion_sort, INSTANCE)(STORED* data, size_t size) {
+    for (size_t i = 1; i < size; i++) {
+        STORED val = data[i];
+        size_t j   = i;
+        while (j > 0 && LESS(&val, &data[j - 1])) {
+            data[j] = data[j - 1];
+            j--;
+        }
+        data[j] = val;
+    }
+}
+
+// restores max-heap property of the subtree at root
+RIFF_API(void) RIFF_INST(algo_internal_sift_down, INSTANCE)(STORED* data, size_t root, size_t size) {
+    STORED val = data[root];
+    for (;;) {
+        size_t child = root * 2 + 1;
+        if (child >= size) break;
+        if (child + 1 < size && LESS(&data[child], &data[child + 1])) child++;
+        if (!LESS(&val, &data[child])) break;
+        data[root] = data[child];
+        root = child;
+    }
+    data[root] = val;
+}
+
+RIFF_API(void) RIFF_INST(algo_internal_make_heap, INSTANCE)(STORED* data, size_t size) {
+    for (size_t i = size / 2; i-- > 0;) RIFF_INST(algo_internal_sift_down, INSTANCE)(data, i, size);
+}
+
+RIFF_API(void) RIFF_INST(algo_internal_sort_heap, INSTANCE)(STORED* data, size_t size) {
+    for (size_t end = size; end > 1; end--) {
+        RIFF_INST(algo_internal_swap, INSTANCE)(&data[0], &data[end - 1]);
+        RIFF_INST(algo_internal_sift_down, INSTANCE)(data, 0, end - 1);
+    }
+}
+
+// median of three partition, requires size >= 3
+// returns p, such that [0, p) <= pivot <= [p, size), both sides non empty
+RIFF_API(size_t) RIFF_INST(algo_internal_partition, INSTANCE)(STORED* data, size_t size) {
+    size_t mid = size / 2;
+
+    // order first, middle and last - they become sentinels for the scans below
+    if (LESS(&data[mid], &data[0]))        RIFF_INST(algo_internal_swap, INSTANCE)(&data[mid], &data[0]);
+    if (LESS(&data[size - 1], &data[mid])) RIFF_INST(algo_internal_swap, INSTANCE)(&data[size - 1], &data[mid]);
+    if (LESS(&data[mid], &data[0]))        RIFF_INST(algo_internal_swap, INSTANCE)(&data[mid], &data[0]);
+
+    STORED pivot = data[mid];
+    size_t i = 0;
+    size_t j = size - 1;
+
+    for (;;) {
+        while (LESS(&data[++i], &pivot));
+        while (LESS(&pivot, &data[--j]));
+        if (i >= j) return i;
+        RIFF_INST(algo_internal_swap, INSTANCE)(&data[i], &data[j]);
+    }
+}
+
+RIFF_API(void) RIFF_INST(algo_internal_introsort, INSTANCE)(STORED* data, size_t size, size_t depth) {
+    while (size > SMALL_SORT) {
+        // too many bad pivots, fall back to guaranteed O(n log n)
+        if (depth == 0) {
+            RIFF_INST(algo_internal_make_heap, INSTANCE)(data, size);
+            RIFF_INST(algo_internal_sort_heap, INSTANCE)(data, size);
+            return;
+        }
+        depth--;
+
+        // recurse into smaller part, loop on the larger one - O(log n) stack
+        size_t p = RIFF_INST(algo_internal_partition, INSTANCE)(data, size);
+        if (p < size - p) {
+            RIFF_INST(algo_internal_introsort, INSTANCE)(data, p, depth);
+            data += p;
+            size -= p;
+        }
+        else {
+            RIFF_INST(algo_internal_introsort, INSTANCE)(data + p, size - p, depth);
+            size = p;
+        }
+    }
+    RIFF_INST(algo_internal_insertion_sort, INSTANCE)(data, size);
+}
+
+/*
+    Sorting
+*/
+
+// Sorts given buffer ascending, using introsort (quicksort, heapsort fallback, insertion sort for small ranges)
+// Not stable, does not allocate
+// O(n log n)
+#define algo_sort(inst) RIFF_INST(algo_sort, inst)
+
+RIFF_API(void) algo_sort(INSTANCE)(STORED* data, size_t size) {
+    size_t depth = 0;
+    for (size_t n = size; n > 1; n >>= 1) depth += 2;
+    RIFF_INST(algo_internal_introsort, INSTANCE)(data, size, depth);
+}
+
+// Merges two sorted buffers into out, which must fit size_a + size_b elements
+// Stable - on ties elements of a come first. Out must not overlap with a or b
+// O(size_a + size_b)
+#define algo_merge(inst) RIFF_INST(algo_merge, inst)
+
+RIFF_API(void) algo_merge(INSTANCE)(const STORED* a, size_t size_a, const STORED* b, size_t size_b, STORED* out) {
+    const STORED* a_end = a + size_a;
+    const STORED* b_end = b + size_b;
+
+    // already in order, just copy
+    if (size_a == 0 || size_b == 0 || !LESS(b, a_end - 1)) {
+        memcpy(out, a, size_a * sizeof(STORED));
+        memcpy(out + size_a, b, size_b * sizeof(STORED));
+        return;
+    }
+
+    while (a < a_end && b < b_end) {
+        if (LESS(b, a)) *out++ = *b++;
+        else            *out++ = *a++;
+    }
+    memcpy(out, a, (size_t)(a_end - a) * sizeof(STORED));
+    out += a_end - a;
+    memcpy(out, b, (size_t)(b_end - b) * sizeof(STORED));
+}
+
+// Sorts given buffer ascending, preserving order of equal elements (bottom-up merge sort)
+// Allocates temporary buffer of size elements
+// May fail (allocation), buffer is left unchanged then, O(n log n)
+#define algo_stable_sort(inst) RIFF_INST(algo_stable_sort, inst)
+
+RIFF_API(int) algo_stable_sort(INSTANCE)(STORED* data, size_t size) {
+    if (size <= MERGE_RUN) {
+        RIFF_INST(algo_internal_insertion_sort, INSTANCE)(data, size);
+        return SCC;
+    }
+
+    STORED* buff = (STORED*)RIFF_ALLOC(size * sizeof(STORED));
+    if (!buff) return ERR;
+
+    // sort small runs in place
+    for (size_t lo = 0; lo < size; lo += MERGE_RUN) {
+        size_t len = size - lo < MERGE_RUN ? size - lo : MERGE_RUN;
+        RIFF_INST(algo_internal_insertion_sort, INSTANCE)(data + lo, len);
+    }
+
+    // merge runs, ping-ponging between data and buffer
+    STORED* src = data;
+    STORED* dst = buff;
+    for (size_t width = MERGE_RUN; width < size; width *= 2) {
+        for (size_t lo = 0; lo < size; lo += 2 * width) {
+            size_t mid = lo + width     < size ? lo + width     : size;
+            size_t hi  = lo + 2 * width < size ? lo + 2 * width : size;
+            algo_merge(INSTANCE)(src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+        }
+        STORED* tmp = src; src = dst; dst = tmp;
+    }
+
+    if (src != data) memcpy(data, src, size * sizeof(STORED));
+    RIFF_FREE(buff);
+    return SCC;
+}
+
+#if !RIFF_IS_EMPTY(RADIX_KEY)
+
+// Sorts given buffer ascending by radix keys (LSD radix sort, 8 bits per pass)
+// Stable, passes where all keys share the same byte are skipped
+// Allocates temporary buffer of size elements
+// May fail (allocation), buffer is left unchanged then, O(n * key bytes)
+#define algo_radix_sort(inst) RIFF_INST(algo_radix_sort, inst)
+
+RIFF_API(int) algo_radix_sort(INSTANCE)(STORED* data, size_t size) {
+    if (size <= SMALL_SORT) {
+        RIFF_INST(algo_internal_insertion_sort, INSTANCE)(data, size);
+        return SCC;
+    }
+
+    STORED* buff = (STORED*)RIFF_ALLOC(size * sizeof(STORED));
+    if (!buff) return ERR;
+
+    // histograms of every byte in one pass
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < size; i++) {
+        uint64_t key = RADIX_KEY(&data[i]);
+        for (int b = 0; b < 8; b++) counts[b][(key >> (b * 8)) & 0xFF]++;
+    }
+
+    STORED* src = data;
+    STORED* dst = buff;
+    uint64_t first_key = RADIX_KEY(&data[0]);
+
+    for (int b = 0; b < 8; b++) {
+        size_t* count = counts[b];
+        int     shift = b * 8;
+
+        // every key has the same byte here, pass would not change anything
+        if (count[(first_key >> shift) & 0xFF] == size) continue;
+
+        size_t offset = 0;
+        for (int d = 0; d < 256; d++) {
+            size_t c = count[d];
+            count[d] = offset;
+            offset  += c;
+        }
+
+        for (size_t i = 0; i < size; i++) dst[count[(RADIX_KEY(&src[i]) >> shift) & 0xFF]++] = src[i];
+
+        STORED* tmp = src; src = dst; dst = tmp;
+    }
+
+    if (src != data) memcpy(data, src, size * sizeof(STORED));
+    RIFF_FREE(buff);
+    return SCC;
+}
+
+#endif
+
+// Rearranges buffer, so that its first k elements are the smallest ones, sorted ascending
+// Order of the remaining elements is unspecified. If k > size whole buffer is sorted
+// O(n log k)
+#define algo_partial_sort(inst) RIFF_INST(algo_partial_sort, inst)
+
+RIFF_API(void) algo_partial_sort(INSTANCE)(STORED* data, size_t size, size_t k) {
+    if (k > size) k = size;
+    if (k == 0) return;
+
+    // keep k smallest seen so far in a max-heap
+    RIFF_INST(algo_internal_make_heap, INSTANCE)(data, k);
+    for (size_t i = k; i < size; i++) {
+        if (LESS(&data[i], &data[0])) {
+            RIFF_INST(algo_internal_swap, INSTANCE)(&data[i], &data[0]);
+            RIFF_INST(algo_internal_sift_down, INSTANCE)(data, 0, k);
+        }
+    }
+    RIFF_INST(algo_internal_sort_heap, INSTANCE)(data, k);
+}
+
+// Rearranges buffer, so that data[nth] is the element which would be there if the buffer was sorted
+// Elements before it are not greater, elements after it are not less
+// No effect if nth >= size
+// O(n) avg, O(n log n) worst
+#define algo_nth_element(inst) RIFF_INST(algo_nth_element, inst)
+
+RIFF_API(void) algo_nth_element(INSTANCE)(STORED* data, size_t size, size_t nth) {
+    if (nth >= size) return;
+
+    size_t depth = 0;
+    for (size_t n = size; n > 1; n >>= 1) depth += 2;
+
+    while (size > SMALL_SORT) {
+        // too many bad pivots, just sort what is left
+        if (depth-- == 0) {
+            RIFF_INST(algo_internal_introsort, INSTANCE)(data, size, 0);
+            return;
+        }
+
+        size_t p = RIFF_INST(algo_internal_partition, INSTANCE)(data, size);
+        if (nth < p) size = p;
+        else {
+            data += p;
+            size -= p;
+            nth  -= p;
+        }
+    }
+    RIFF_INST(algo_internal_insertion_sort, INSTANCE)(data, size);
+}
+
+/*
+    Searching
+*/
+
+// Returns whether the buffer is sorted ascending
+// O(n)
+#define algo_is_sorted(inst) RIFF_INST(algo_is_sorted, inst)
+
+RIFF_API(int) algo_is_sorted(INSTANCE)(const STORED* data, size_t size) {
+    for (size_t i = 1; i < size; i++) if (LESS(&data[i], &data[i - 1])) return 0;
+    return 1;
+}
+
+// Returns index of the first element of the sorted buffer which is not less than value
+// Returns size if there is no such element
+// Branchless binary search, O(log n)
+#define algo_lower_bound(inst) RIFF_INST(algo_lower_bound, inst)
+
+RIFF_API(size_t) algo_lower_bound(INSTANCE)(const STORED* data, size_t size, const STORED* value) {
+    if (size == 0) return 0;
+
+    const STORED* base = data;
+    while (size > 1) {
+        size_t half = size / 2;
+        base = LESS(&base[half], value) ? base + half : base;
+        size -= half;
+    }
+    return (size_t)(base - data) + (LESS(base, value) ? 1 : 0);
+}
+
+// Returns index of the first element of the sorted buffer which is greater than value
+// Returns size if there is no such element
+// Branchless binary search, O(log n)
+#define algo_upper_bound(inst) RIFF_INST(algo_upper_bound, inst)
+
+RIFF_API(size_t) algo_upper_bound(INSTANCE)(const STORED* data, size_t size, const STORED* value) {
+    if (size == 0) return 0;
+
+    const STORED* base = data;
+    while (size > 1) {
+        size_t half = size / 2;
+        base = LESS(value, &base[half]) ? base : base + half;
+        size -= half;
+    }
+    return (size_t)(base - data) + (LESS(value, base) ? 0 : 1);
+}
+
+// Searches sorted buffer for element equal to value (neither less nor greater)
+// If succeeded and index is not NULL, sets *index to position of the first such element
+// May fail (no such element), O(log n)
+#define algo_binary_search(inst) RIFF_INST(algo_binary_search, inst)
+
+RIFF_API(int) algo_binary_search(INSTANCE)(const STORED* data, size_t size, const STORED* value, size_t* index) {
+    size_t pos = algo_lower_bound(INSTANCE)(data, size, value);
+    if (pos == size || LESS(value, &data[pos])) return ERR;
+
+    if (index) *index = pos;
+    return SCC;
+}
+
+#undef SMALL_SORT
+#undef MERGE_RUN
+
+#undef INSTANCE
+#undef STORED
+#undef LESS
+#undef RADIX_KEY
+
+// consume parameters
+#undef T
+#undef A
@@ -0,0 +1,306 @@
+/*
+    T macro pattern
+        [instance name], [key type],
+        [key type hash function - size_t(func)(const KEY*)],
+        [hhmap instance (opt) - hhmap of the same key type, included beforehand],
+        [hhmap stored type (opt) - required with hhmap instance]
+
+    Blocked Bloom filter - approximate set membership with false positives but no false negatives
+    Every key sets 8 bits within one 64 byte block (one bit in each 64 bit word), so an insert or
+    a query touches a single cache line. Keys are not stored, the filter cannot remove them
+    Hash is the hhmap one, its result is remixed, so weak hashes (e.g. identity) are fine
+
+    Sized by bloom_reset() from expected count of keys and target false positive rate
+    Rates below ~2e-6 are clamped (48 bits per key), the rate grows when more keys are inserted than expected
+    Zero-initialized (or not yet sized) filter has no blocks and answers "maybe" for every key
+
+    With hhmap instance, bloom_hhmap_push() / bloom_hhmap_find() keep the filter in front of that hhmap,
+    so most misses are rejected without touching the table. Keys popped from the map stay in the filter
+    (as false positives), bloom_reset() and re-inserting the keys drops them
+*/
+
+#include "generic.h"
+#include "hash.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Blocks
+*/
+
+#ifndef RIFF_BLOOM_BLOCKS
+#define RIFF_BLOOM_BLOCKS
+
+// One cache line of filter bits
+typedef struct riff_bloom_block {
+    uint64_t words[8];
+} riff_bloom_block;
+
+// queries hashed and prefetched at once by bloom_contains_many()
+#define RIFF_BLOOM_BATCH 16
+
+// odd multipliers picking the bit of every word from the low 32 bits of the hash
+static const uint32_t riff_bloom_salt[8] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+};
+
+// false positive rate of 4, 6, ... 48 bits per key (Poisson distributed block loads)
+static const double riff_bloom_rate[23] = {
+    3.19e-1, 9.29e-2, 2.93e-2, 1.05e-2, 4.22e-3, 1.88e-3, 9.09e-4, 4.72e-4, 2.60e-4, 1.50e-4, 9.09e-5, 5.70e-5,
+    3.70e-5, 2.47e-5, 1.69e-5, 1.18e-5, 8.45e-6, 6.15e-6, 4.55e-6, 3.42e-6, 2.61e-6, 2.01e-6, 1.57e-6
+};
+
+// Returns bits per key needed for given false positive rate
+// O(1)
+RIFF_API(size_t) riff_bloom_bits_per_key(double rate) {
+    size_t i = 0;
+    while (i < 22 && riff_bloom_rate[i] > rate) i++;
+    return 4 + 2 * i;
+}
+
+// Returns block of the hash, among count blocks (multiply-shift, no division)
+// O(1)
+RIFF_API(size_t) riff_bloom_block_of(uint64_t hash, size_t count) {
+    return (size_t)(((hash >> 32) * (uint64_t)count) >> 32);
+}
+
+// Sets 8 bits of the hash in the block
+// O(1)
+RIFF_API(void) riff_bloom_set(riff_bloom_block* block, uint64_t hash) {
+    uint32_t h = (uint32_t)hash;
+    for (int i = 0; i < 8; i++) block->words[i] |= (uint64_t)1 << ((h * riff_bloom_salt[i]) >> 26);
+}
+
+// Returns non-0 if all 8 bits of the hash are set in the block, branchless
+// O(1)
+RIFF_API(int) riff_bloom_test(const riff_bloom_block* block, uint64_t hash) {
+    uint32_t h   = (uint32_t)hash;
+    uint64_t all = 1;
+    for (int i = 0; i < 8; i++) all &= block->words[i] >> ((h * riff_bloom_salt[i]) >> 26);
+    return (int)all;
+}
+
+#endif // RIFF_BLOOM_BLOCKS
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE RIFF_FIRST(T)
+#define KEY      RIFF_SECOND(T)
+#define HASH     RIFF_THIRD(T)
+#define MAP      RIFF_FOURTH(T, , )
+#define MAP_VAL  RIFF_FIFTH(T, , )
+
+#define KEY_HASH(key_ptr) riff_mix64((uint64_t)HASH(key_ptr))
+
+// blocks are < 2^32, see riff_bloom_block_of()
+#define MAX_BLOCKS ((size_t)UINT32_MAX)
+
+/*
+    Typedef
+*/
+
+// Blocked Bloom filter (bloom)
+// Cache line sized blocks, 64 byte aligned, O(1) insert and query touching one line
+// O(n) memory complexity, bits per key chosen from the false positive rate
+#define bloom(inst) RIFF_INST(bloom, inst)
+
+typedef struct bloom(INSTANCE) {
+    riff_bloom_block* priv_blocks; // 64 byte aligned, inside priv_mem
+    void*             priv_mem;
+    size_t            priv_count;  // count of blocks
+    size_t            priv_size;   // count of inserts
+} bloom(INSTANCE);
+
+/*
+    Zero / Destruction
+*/
+
+// Makes unitialized memory proper 0-initialized filter without blocks
+// Does not free anything
+#define bloom_zero(inst) RIFF_INST(bloom_zero, inst)
+
+RIFF_API(void) bloom_zero(INSTANCE)(bloom(INSTANCE)* tar) {
+    tar->priv_blocks = NULL;
+    tar->priv_mem    = NULL;
+    tar->priv_count  = 0;
+    tar->priv_size   = 0;
+}
+
+// Frees the blocks
+// O(1)
+#define bloom_destroy(inst) RIFF_INST(bloom_destroy, inst)
+
+RIFF_API(void) bloom_destroy(INSTANCE)(bloom(INSTANCE)* tar) {
+    RIFF_FREE(tar->priv_mem);
+    bloom_zero(INSTANCE)(tar);
+}
+
+/*
+    Memory
+*/
+
+// Sizes the filter for expected count of keys at given false positive rate (e.g. 0.01)
+// All keys are dropped
+// May fail (allocation), O(blocks)
+#define bloom_reset(inst) RIFF_INST(bloom_reset, inst)
+
+RIFF_API(int) bloom_reset(INSTANCE)(bloom(INSTANCE)* tar, size_t expected, double rate) {
+    size_t bits_per_key = riff_bloom_bits_per_key(rate);
+    if (expected == 0) expected = 1;
+    if (expected > MAX_BLOCKS * 512 / bits_per_key) return ERR;
+
+    size_t count = (expected * bits_per_key + 511) / 512;
+
+    // one spare block for the alignment
+    void* mem = RIFF_ALLOC((count + 1) * sizeof(riff_bloom_block));
+    if (!mem) return ERR;
+    RIFF_FREE(tar->priv_mem);
+
+    uintptr_t aligned = ((uintptr_t)mem + 63) & ~(uintptr_t)63;
+    tar->priv_blocks = (riff_bloom_block*)aligned;
+    tar->priv_mem    = mem;
+    tar->priv_count  = count;
+    tar->priv_size   = 0;
+    memset(tar->priv_blocks, 0, count * sizeof(riff_bloom_block));
+    return SCC;
+}
+
+/*
+    Query
+*/
+
+// Returns count of inserts (repeated keys are counted again)
+// O(1)
+#define bloom_size(inst) RIFF_INST(bloom_size, inst)
+
+RIFF_API(size_t) bloom_size(INSTANCE)(const bloom(INSTANCE)* tar) {
+    return tar->priv_size;
+}
+
+// Returns size of the filter in bytes
+// O(1)
+#define bloom_bytes(inst) RIFF_INST(bloom_bytes, inst)
+
+RIFF_API(size_t) bloom_bytes(INSTANCE)(const bloom(INSTANCE)* tar) {
+    return tar->priv_count * sizeof(riff_bloom_block);
+}
+
+/*
+    Operations
+*/
+
+// Inserts key, no-op for filter without blocks
+// O(1)
+#define bloom_insert(inst) RIFF_INST(bloom_insert, inst)
+
+RIFF_API(void) bloom_insert(INSTANCE)(bloom(INSTANCE)* tar, KEY key) {
+    if (tar->priv_count == 0) return;
+
+    uint64_t hash = KEY_HASH(&key);
+    riff_bloom_set(&tar->priv_blocks[riff_bloom_block_of(hash, tar->priv_count)], hash);
+    tar->priv_size++;
+}
+
+// Returns 0 if the key was certainly not inserted, non-0 if it may have been
+// O(1)
+#define bloom_contains(inst) RIFF_INST(bloom_contains, inst)
+
+RIFF_API(int) bloom_contains(INSTANCE)(const bloom(INSTANCE)* tar, KEY key) {
+    if (tar->priv_count == 0) return 1;
+
+    uint64_t hash = KEY_HASH(&key);
+    return riff_bloom_test(&tar->priv_blocks[riff_bloom_block_of(hash, tar->priv_count)], hash);
+}
+
+// Queries count keys, out[i] is set as bloom_contains() of keys[i] would return
+// Hashes a batch of keys and prefetches their blocks before testing any, so cache misses overlap
+// Returns count of keys which may have been inserted
+// O(count)
+#define bloom_contains_many(inst) RIFF_INST(bloom_contains_many, inst)
+
+RIFF_API(size_t) bloom_contains_many(INSTANCE)(const bloom(INSTANCE)* tar, const KEY* keys, size_t count, unsigned char* out) {
+    if (tar->priv_count == 0) {
+        memset(out, 1, count);
+        return count;
+    }
+
+    size_t   found = 0;
+    uint64_t hashes[RIFF_BLOOM_BATCH];
+    size_t   blocks[RIFF_BLOOM_BATCH];
+
+    for (size_t i = 0; i < count; i += RIFF_BLOOM_BATCH) {
+        size_t batch = count - i < RIFF_BLOOM_BATCH ? count - i : RIFF_BLOOM_BATCH;
+
+        for (size_t j = 0; j < batch; j++) {
+            hashes[j] = KEY_HASH(&keys[i + j]);
+            blocks[j] = riff_bloom_block_of(hashes[j], tar->priv_count);
+            RIFF_PREFETCH(&tar->priv_blocks[blocks[j]]);
+        }
+        for (size_t j = 0; j < batch; j++) {
+            out[i + j] = (unsigned char)riff_bloom_test(&tar->priv_blocks[blocks[j]], hashes[j]);
+            found += out[i + j];
+        }
+    }
+    return found;
+}
+
+// Drops all keys, keeps the size
+// O(blocks)
+#define bloom_clear(inst) RIFF_INST(bloom_clear, inst)
+
+RIFF_API(void) bloom_clear(INSTANCE)(bloom(INSTANCE)* tar) {
+    if (tar->priv_count) memset(tar->priv_blocks, 0, tar->priv_count * sizeof(riff_bloom_block));
+    tar->priv_size = 0;
+}
+
+/*
+    hhmap Helpers
+*/
+
+#if !RIFF_IS_EMPTY(MAP)
+
+// Pushes into the map as hhmap_push(), inserts the key into the filter on success
+// May fail (map resize failure), O(1) avg
+#define bloom_hhmap_push(inst) RIFF_INST(bloom_hhmap_push, inst)
+
+RIFF_API(int) bloom_hhmap_push(INSTANCE)(bloom(INSTANCE)* filter, hhmap(MAP)* map, KEY key, MAP_VAL value) {
+    if (hhmap_push(MAP)(map, key, value) == ERR) return ERR;
+    bloom_insert(INSTANCE)(filter, key);
+    return SCC;
+}
+
+// Searches the map as hhmap_find(), unless the filter rules the key out
+// Keys must get into the map through bloom_hhmap_push() (or be inserted into the filter too)
+// May fail (if no given key), O(1) avg, misses mostly without touching the map
+#define bloom_hhmap_find(inst) RIFF_INST(bloom_hhmap_find, inst)
+
+RIFF_API(int) bloom_hhmap_find(INSTANCE)(const bloom(INSTANCE)* filter, hhmap(MAP)* map, KEY key, const KEY** inner_key, MAP_VAL** value) {
+    if (!bloom_contains(INSTANCE)(filter, key)) return ERR;
+    return hhmap_find(MAP)(map, key, inner_key, value);
+}
+
+#endif
+
+#undef KEY_HASH
+#undef MAX_BLOCKS
+
+#undef INSTANCE
+#undef KEY
+#undef HASH
+#undef MAP
+#undef MAP_VAL
+
+// consume parameters
+#undef T
+#undef A
@@ -0,0 +1,686 @@
+/*
+    T macro pattern
+        [instance name],
+        [key type],    [key type destructor (opt)],
+        [value type],  [value type destructor (opt)],
+        [key type less function - int(func)(const KEY* a, const KEY* b) (non-0 if a < b)],
+        [node size in bytes (opt) - 256 by default]
+*/
+
+#include "generic.h"
+
+#include <string.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE   RIFF_FIRST(T)
+#define KEY        RIFF_SECOND(T)
+#define KEY_DEST   RIFF_THIRD(T)
+#define VAL        RIFF_FOURTH(T)
+#define VAL_DEST   RIFF_FIFTH(T)
+#define LESS       RIFF_SIXTH(T)
+#define NODE_BYTES RIFF_OR_DEFAULT(RIFF_SEVENTH(T, , ), 256)
+#define TRIVIAL    (RIFF_IS_EMPTY(KEY_DEST) && RIFF_IS_EMPTY(VAL_DEST))
+
+// keys per node, so that keys and values of a node fit in NODE_BYTES (at least 3)
+#define NODE_FIT  ((NODE_BYTES - 16) / (sizeof(KEY) + sizeof(VAL)))
+#define NODE_CAPC (NODE_FIT < 3 ? 3 : NODE_FIT)
+#define MIN_KEYS  ((NODE_CAPC - 1) / 2)
+
+#define NODE  btree_node(INSTANCE)
+#define INNER RIFF_INST(btree_inner, INSTANCE)
+
+#define CHILD(n, i) (((INNER*)(n))->priv_children[i])
+
+#if RIFF_IS_EMPTY(KEY_DEST)
+    #define KEY_DESTROY(ptr)
+#else
+    #define KEY_DESTROY(ptr) KEY_DEST(ptr)
+#endif
+
+#if RIFF_IS_EMPTY(VAL_DEST)
+    #define VAL_DESTROY(ptr)
+#else
+    #define VAL_DESTROY(ptr) VAL_DEST(ptr)
+#endif
+
+/*
+    Typedef
+*/
+
+// B-tree map (btree) node
+// Keys and values of a node are stored in separate contiguous arrays,
+// inner nodes additionally store children pointers
+#define btree_node(inst) RIFF_INST(btree_node, inst)
+
+typedef struct btree_node(INSTANCE) {
+    struct btree_node(INSTANCE)* priv_parent;
+    unsigned short               priv_count;
+    unsigned char                priv_leaf;
+    KEY                          priv_keys[NODE_CAPC];
+    VAL                          priv_values[NODE_CAPC];
+} btree_node(INSTANCE);
+
+typedef struct INNER {
+    NODE  priv_base;
+    NODE* priv_children[NODE_CAPC + 1];
+} INNER;
+
+// B-tree map (btree)
+// Ordered map, allowing O(log n) access to elements by keys and in-order iteration
+// Nodes are sized to span few cache lines, so a lookup touches only O(log n) of them
+// O(n) memory complexity
+#define btree(inst) RIFF_INST(btree, inst)
+
+typedef struct btree(INSTANCE) {
+    NODE*  priv_root;
+    size_t priv_size;
+} btree(INSTANCE);
+
+// B-tree map iterator (btree_iter)
+// Points to a single element, or nowhere (invalid) - past the end / before the beginning
+// Invalidated by any push / pop on the map
+#define btree_iter(inst) RIFF_INST(btree_iter, inst)
+
+typedef struct btree_iter(INSTANCE) {
+    NODE*  priv_node;
+    size_t priv_idx;
+} btree_iter(INSTANCE);
+
+/*
+    Internals
+*/
+
+// allocates empty node, NULL on failure
+RIFF_API(NODE*) RIFF_INST(btree_internal_alloc, INSTANCE)(int leaf) {
+    NODE* n = (NODE*)RIFF_ALLOC(leaf ? sizeof(NODE) : sizeof(INNER));
+    if (!n) return NULL;
+
+    n->priv_parent = NULL;
+    n->priv_count  = 0;
+    n->priv_leaf   = (unsigned char)leaf;
+    return n;
+}
+
+// frees subtree, calling destructors if destroy is non-0
+RIFF_API(void) RIFF_INST(btree_internal_free, INSTANCE)(NODE* n, int destroy) {
+    if (!n->priv_leaf) {
+        for (size_t i = 0; i <= n->priv_count; i++) RIFF_INST(btree_internal_free, INSTANCE)(CHILD(n, i), destroy);
+    }
+#if !TRIVIAL
+    if (destroy) {
+        for (size_t i = 0; i < n->priv_count; i++) {
+            KEY_DESTROY(&n->priv_keys[i]);
+            VAL_DESTROY(&n->priv_values[i]);
+        }
+    }
+#else
+    (void)destroy;
+#endif
+    RIFF_FREE(n);
+}
+
+// index of the first key of the node not less than key
+RIFF_API(size_t) RIFF_INST(btree_internal_search, INSTANCE)(const NODE* n, const KEY* key) {
+    size_t lo = 0;
+    size_t hi = n->priv_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (LESS(&n->priv_keys[mid], key)) lo = mid + 1;
+        else                               hi = mid;
+    }
+    return lo;
+}
+
+// index of n within its parent's children
+RIFF_API(size_t) RIFF_INST(btree_internal_child_idx, INSTANCE)(const NODE* n) {
+    size_t i = 0;
+    while (CHILD(n->priv_parent, i) != n) i++;
+    return i;
+}
+
+// moves entries [from, from + amount) of src into dst at position at (dst has room)
+RIFF_API(void) RIFF_INST(btree_internal_move, INSTANCE)(NODE* dst, size_t at, NODE* src, size_t from, size_t amount) {
+    memmove(&dst->priv_keys[at],   &src->priv_keys[from],   amount * sizeof(KEY));
+    memmove(&dst->priv_values[at], &src->priv_values[from], amount * sizeof(VAL));
+}
+
+// moves children [from, from + amount) of src into dst at position at, updating their parents
+RIFF_API(void) RIFF_INST(btree_internal_move_children, INSTANCE)(NODE* dst, size_t at, NODE* src, size_t from, size_t amount) {
+    memmove(&CHILD(dst, at), &CHILD(src, from), amount * sizeof(NODE*));
+    for (size_t i = at; i < at + amount; i++) CHILD(dst, i)->priv_parent = dst;
+}
+
+// splits full i-th child of parent (which is not full) into two, median goes into parent
+// May fail (allocation), tree is unchanged then
+RIFF_API(int) RIFF_INST(btree_internal_split, INSTANCE)(NODE* parent, size_t i) {
+    NODE* child = CHILD(parent, i);
+    NODE* right = RIFF_INST(btree_internal_alloc, INSTANCE)(child->priv_leaf);
+    if (!right) return ERR;
+
+    size_t mid = NODE_CAPC / 2;
+    right->priv_parent = parent;
+    right->priv_count  = (unsigned short)(NODE_CAPC - mid - 1);
+    RIFF_INST(btree_internal_move, INSTANCE)(right, 0, child, mid + 1, right->priv_count);
+    if (!child->priv_leaf) RIFF_INST(btree_internal_move_children, INSTANCE)(right, 0, child, mid + 1, right->priv_count + 1u);
+    child->priv_count = (unsigned short)mid;
+
+    // make room in parent and lift the median
+    RIFF_INST(btree_internal_move, INSTANCE)(parent, i + 1, parent, i, parent->priv_count - i);
+    memmove(&CHILD(parent, i + 2), &CHILD(parent, i + 1), (parent->priv_count - i) * sizeof(NODE*));
+    parent->priv_keys[i]      = child->priv_keys[mid];
+    parent->priv_values[i]    = child->priv_values[mid];
+    CHILD(parent, i + 1)      = right;
+    parent->priv_count++;
+    return SCC;
+}
+
+// restores minimal fill of node n, after a key was removed from it
+RIFF_API(void) RIFF_INST(btree_internal_rebalance, INSTANCE)(btree(INSTANCE)* tar, NODE* n) {
+    while (n->priv_parent && n->priv_count < MIN_KEYS) {
+        NODE*  parent = n->priv_parent;
+        size_t i      = RIFF_INST(btree_internal_child_idx, INSTANCE)(n);
+        NODE*  left   = i > 0                  ? CHILD(parent, i - 1) : NULL;
+        NODE*  right  = i < parent->priv_count ? CHILD(parent, i + 1) : NULL;
+
+        // borrow from left sibling through the parent
+        if (left && left->priv_count > MIN_KEYS) {
+            RIFF_INST(btree_internal_move, INSTANCE)(n, 1, n, 0, n->priv_count);
+            n->priv_keys[0]              = parent->priv_keys[i - 1];
+            n->priv_values[0]            = parent->priv_values[i - 1];
+            parent->priv_keys[i - 1]     = left->priv_keys[left->priv_count - 1];
+            parent->priv_values[i - 1]   = left->priv_values[left->priv_count - 1];
+            if (!n->priv_leaf) {
+                RIFF_INST(btree_internal_move_children, INSTANCE)(n, 1, n, 0, n->priv_count + 1u);
+                RIFF_INST(btree_internal_move_children, INSTANCE)(n, 0, left, left->priv_count, 1);
+            }
+            left->priv_count--;
+            n->priv_count++;
+            return;
+        }
+
+        // borrow from right sibling through the parent
+        if (right && right->priv_count > MIN_KEYS) {
+            n->priv_keys[n->priv_count]   = parent->priv_keys[i];
+            n->priv_values[n->priv_count] = parent->priv_values[i];
+            parent->priv_keys[i]          = right->priv_keys[0];
+            parent->priv_values[i]        = right->priv_values[0];
+            RIFF_INST(btree_internal_move, INSTANCE)(right, 0, right, 1, right->priv_count - 1u);
+            if (!n->priv_leaf) {
+                RIFF_INST(btree_internal_move_children, INSTANCE)(n, n->priv_count + 1u, right, 0, 1);
+                RIFF_INST(btree_internal_move_children, INSTANCE)(right, 0, right, 1, right->priv_count);
+            }
+            right->priv_count--;
+            n->priv_count++;
+            return;
+        }
+
+        // merge with a sibling, separator from parent goes between them
+        if (!left) {
+            left  = n;
+            i    += 1;
+        }
+        else right = n;
+
+        left->priv_keys[left->priv_count]   = parent->priv_keys[i - 1];
+        left->priv_values[left->priv_count] = parent->priv_values[i - 1];
+        RIFF_INST(btree_internal_move, INSTANCE)(left, left->priv_count + 1u, right, 0, right->priv_count);
+        if (!left->priv_leaf) RIFF_INST(btree_internal_move_children, INSTANCE)(left, left->priv_count + 1u, right, 0, right->priv_count + 1u);
+        left->priv_count = (unsigned short)(left->priv_count + 1u + right->priv_count);
+        RIFF_FREE(right);
+
+        // drop separator and right child from the parent
+        RIFF_INST(btree_internal_move, INSTANCE)(parent, i - 1, parent, i, parent->priv_count - i);
+        memmove(&CHILD(parent, i), &CHILD(parent, i + 1), (parent->priv_count - i) * sizeof(NODE*));
+        parent->priv_count--;
+
+        n = parent;
+    }
+
+    // root emptied by a merge, tree gets lower
+    if (!n->priv_parent && n->priv_count == 0) {
+        if (n->priv_leaf) tar->priv_root = NULL;
+        else {
+            tar->priv_root = CHILD(n, 0);
+            tar->priv_root->priv_parent = NULL;
+        }
+        RIFF_FREE(n);
+    }
+}
+
+/*
+    Zero / Destruction
+*/
+
+// Makes unitialized memory proper 0-initialized empty map
+// Does not free anything
+#define btree_zero(inst) RIFF_INST(btree_zero, inst)
+
+RIFF_API(void) btree_zero(INSTANCE)(btree(INSTANCE)* tar) {
+    tar->priv_root = NULL;
+    tar->priv_size = 0;
+}
+
+// Frees map and its keys and values
+// O(n)
+#define btree_destroy(inst) RIFF_INST(btree_destroy, inst)
+
+RIFF_API(void) btree_destroy(INSTANCE)(btree(INSTANCE)* tar) {
+    if (tar->priv_root) RIFF_INST(btree_internal_free, INSTANCE)(tar->priv_root, 1);
+    btree_zero(INSTANCE)(tar);
+}
+
+/*
+    Query
+*/
+
+// Returns count of elements in the map
+// O(1)
+#define btree_size(inst) RIFF_INST(btree_size, inst)
+
+RIFF_API(size_t) btree_size(INSTANCE)(const btree(INSTANCE)* tar) {
+    return tar->priv_size;
+}
+
+/*
+    Operations
+*/
+
+// Inserts new or replace value at given key
+// Given key and value are owned by the map on success
+// May fail (allocation), O(log n)
+#define btree_push(inst) RIFF_INST(btree_push, inst)
+
+RIFF_API(int) btree_push(INSTANCE)(btree(INSTANCE)* tar, KEY key, VAL value) {
+    // If none memory assigned, allocate
+    if (!tar->priv_root) {
+        tar->priv_root = RIFF_INST(btree_internal_alloc, INSTANCE)(1);
+        if (!tar->priv_root) return ERR;
+    }
+
+    // full root, grow the tree by one level
+    if (tar->priv_root->priv_count == NODE_CAPC) {
+        NODE* root = RIFF_INST(btree_internal_alloc, INSTANCE)(0);
+        if (!root) return ERR;
+
+        CHILD(root, 0) = tar->priv_root;
+        tar->priv_root->priv_parent = root;
+        if (RIFF_INST(btree_internal_split, INSTANCE)(root, 0) == ERR) {
+            tar->priv_root->priv_parent = NULL;
+            RIFF_FREE(root);
+            return ERR;
+        }
+        tar->priv_root = root;
+    }
+
+    // descend, splitting full nodes on the way, so there is always room for a lifted median
+    NODE* n = tar->priv_root;
+    for (;;) {
+        size_t i = RIFF_INST(btree_internal_search, INSTANCE)(n, &key);
+
+        // key already present, replace
+        if (i < n->priv_count && !LESS(&key, &n->priv_keys[i])) {
+            KEY_DESTROY(&n->priv_keys[i]);   // free old key
+            VAL_DESTROY(&n->priv_values[i]); // free old value
+            n->priv_keys[i]   = key;
+            n->priv_values[i] = value;
+            return SCC;
+        }
+
+        if (n->priv_leaf) {
+            RIFF_INST(btree_internal_move, INSTANCE)(n, i + 1, n, i, n->priv_count - i);
+            n->priv_keys[i]   = key;
+            n->priv_values[i] = value;
+            n->priv_count++;
+            tar->priv_size++;
+            return SCC;
+        }
+
+        if (CHILD(n, i)->priv_count == NODE_CAPC) {
+            if (RIFF_INST(btree_internal_split, INSTANCE)(n, i) == ERR) return ERR;
+            // lifted median may be the key or decide about the side
+            if (!LESS(&key, &n->priv_keys[i]) && !LESS(&n->priv_keys[i], &key)) continue;
+            if (LESS(&n->priv_keys[i], &key)) i++;
+        }
+        n = CHILD(n, i);
+    }
+}
+
+// Searches map for given user_key
+// If succeeded set *key to position of key (changes to it forbiden!)
+// and *value to position of value (can be changed)
+// Note changing the map may lead to invalidation of returned values!
+// *key and *value may be NULL
+// May fail (if no given key), O(log n)
+#define btree_find(inst) RIFF_INST(btree_find, inst)
+
+RIFF_API(int) btree_find(INSTANCE)(btree(INSTANCE)* tar, KEY user_key, const KEY** inner_key, VAL** value) {
+    NODE* n = tar->priv_root;
+    while (n) {
+        size_t i = RIFF_INST(btree_internal_search, INSTANCE)(n, &user_key);
+        if (i < n->priv_count && !LESS(&user_key, &n->priv_keys[i])) {
+            if (inner_key) *inner_key = &n->priv_keys[i];
+            if (value)     *value     = &n->priv_values[i];
+            return SCC;
+        }
+        n = n->priv_leaf ? NULL : CHILD(n, i);
+    }
+    return ERR;
+}
+
+// Removes given key from the map, stored key is destructed
+// if out is NULL, stored value will be destructed (if destructor provided)
+// otherwise it will be moved into *out
+// May fail (if no given key), O(log n)
+#define btree_pop(inst) RIFF_INST(btree_pop, inst)
+
+RIFF_API(int) btree_pop(INSTANCE)(btree(INSTANCE)* tar, KEY user_key, VAL* out) {
+    const KEY* inner;
+    if (btree_find(INSTANCE)(tar, user_key, &inner, NULL) == ERR) return ERR;
+
+    // locate node of the found key
+    NODE* n = tar->priv_root;
+    size_t i;
+    for (;;) {
+        i = RIFF_INST(btree_internal_search, INSTANCE)(n, &user_key);
+        if (i < n->priv_count && &n->priv_keys[i] == inner) break;
+        n = CHILD(n, i);
+    }
+
+    if (out) *out = n->priv_values[i];
+    else     { VAL_DESTROY(&n->priv_values[i]); }
+    KEY_DESTROY(&n->priv_keys[i]);
+
+    if (n->priv_leaf) {
+        RIFF_INST(btree_internal_move, INSTANCE)(n, i, n, i + 1, n->priv_count - i - 1u);
+    }
+    else {
+        // replace with predecessor, the last entry of the rightmost leaf of the left subtree
+        NODE* leaf = CHILD(n, i);
+        while (!leaf->priv_leaf) leaf = CHILD(leaf, leaf->priv_count);
+        n->priv_keys[i]   = leaf->priv_keys[leaf->priv_count - 1];
+        n->priv_values[i] = leaf->priv_values[leaf->priv_count - 1];
+        n = leaf;
+    }
+    n->priv_count--;
+    tar->priv_size--;
+
+    RIFF_INST(btree_internal_rebalance, INSTANCE)(tar, n);
+    return SCC;
+}
+
+// Clears map
+// O(n)
+#define btree_clear(inst) RIFF_INST(btree_clear, inst)
+
+RIFF_API(void) btree_clear(INSTANCE)(btree(INSTANCE)* tar) {
+    btree_destroy(INSTANCE)(tar); // apparently the same
+}
+
+// Builds the map from size keys and values, keys must be sorted strictly ascending
+// (e.g. dyarr_access() buffers). Nodes are filled completely, then the rest goes level up,
+// which gives the lowest possible tree, well suited for read-mostly maps
+// Map must be empty. Keys and values are owned by the map on success
+// May fail (allocation, non-empty map, keys not strictly ascending), map is unchanged then, O(n)
+#define btree_bulk_load(inst) RIFF_INST(btree_bulk_load, inst)
+
+RIFF_API(int) btree_bulk_load(INSTANCE)(btree(INSTANCE)* tar, const KEY* keys, const VAL* values, size_t size) {
+    if (tar->priv_root) return ERR;
+    for (size_t i = 1; i < size; i++) if (!LESS(&keys[i - 1], &keys[i])) return ERR;
+    if (size == 0) return SCC;
+
+    // shape of the tree: a level of m entries is split into k nodes and k - 1 separators going up
+    size_t total = 0;
+    for (size_t m = size;;) {
+        size_t k = (m + NODE_CAPC + 1) / (NODE_CAPC + 1);
+        total += k;
+        if (k == 1) break;
+        m = k - 1;
+    }
+    size_t leaves = (size + NODE_CAPC + 1) / (NODE_CAPC + 1);
+
+    NODE**  nodes = (NODE**) RIFF_ALLOC(total * sizeof(NODE*));
+    size_t* seps  = (size_t*)RIFF_ALLOC(leaves * sizeof(size_t)); // source indices of separators
+    size_t  made  = 0;
+    if (nodes && seps) {
+        for (; made < total; made++) {
+            nodes[made] = RIFF_INST(btree_internal_alloc, INSTANCE)(made < leaves);
+            if (!nodes[made]) break;
+        }
+    }
+
+    if (made < total) {
+        for (size_t j = 0; j < made; j++) RIFF_FREE(nodes[j]);
+        if (nodes) RIFF_FREE(nodes);
+        if (seps)  RIFF_FREE(seps);
+        return ERR;
+    }
+
+    NODE** level    = nodes;   // nodes of the level being built
+    NODE** below    = NULL;    // nodes of the level below
+    size_t m        = size;    // entries of this level
+    for (;;) {
+        size_t k    = (m + NODE_CAPC + 1) / (NODE_CAPC + 1);
+        size_t keys_left = m - (k - 1);
+        size_t pos  = 0;       // entry position within the level
+        size_t kid  = 0;       // child position within the level below
+
+        for (size_t j = 0; j < k; j++) {
+            NODE*  n = level[j];
+            size_t c = keys_left / k + (j < keys_left % k ? 1 : 0);
+
+            for (size_t e = 0; e < c; e++) {
+                size_t src = below ? seps[pos + e] : pos + e;
+                n->priv_keys[e]   = keys[src];
+                n->priv_values[e] = values[src];
+            }
+            n->priv_count = (unsigned short)c;
+
+            if (below) {
+                for (size_t e = 0; e <= c; e++) {
+                    CHILD(n, e) = below[kid++];
+                    CHILD(n, e)->priv_parent = n;
+                }
+            }
+
+            // entry after the node goes one level up (written after its slot was read)
+            if (j + 1 < k) seps[j] = below ? seps[pos + c] : pos + c;
+            pos += c + 1;
+        }
+
+        if (k == 1) break;
+        below  = level;
+        level += k;
+        m      = k - 1;
+    }
+
+    tar->priv_root = level[0];
+    tar->priv_size = size;
+
+    RIFF_FREE(nodes);
+    RIFF_FREE(seps);
+    return SCC;
+}
+
+/*
+    Iteration
+*/
+
+// Returns whether the iterator points to an element
+// O(1)
+#define btree_valid(inst) RIFF_INST(btree_valid, inst)
+
+RIFF_API(int) btree_valid(INSTANCE)(btree_iter(INSTANCE) it) {
+    return it.priv_node != NULL;
+}
+
+// Returns pointer to the key of the element iterator points to (changes to it forbiden!)
+// Iterator must be valid
+// O(1)
+#define btree_key(inst) RIFF_INST(btree_key, inst)
+
+RIFF_API(const KEY*) btree_key(INSTANCE)(btree_iter(INSTANCE) it) {
+    return &it.priv_node->priv_keys[it.priv_idx];
+}
+
+// Returns pointer to the value of the element iterator points to (can be changed)
+// Iterator must be valid
+// O(1)
+#define btree_value(inst) RIFF_INST(btree_value, inst)
+
+RIFF_API(VAL*) btree_value(INSTANCE)(btree_iter(INSTANCE) it) {
+    return &it.priv_node->priv_values[it.priv_idx];
+}
+
+// Returns iterator to the smallest key, invalid one if map is empty
+// O(log n)
+#define btree_first(inst) RIFF_INST(btree_first, inst)
+
+RIFF_API(btree_iter(INSTANCE)) btree_first(INSTANCE)(const btree(INSTANCE)* tar) {
+    btree_iter(INSTANCE) it = { tar->priv_root, 0 };
+    if (it.priv_node) while (!it.priv_node->priv_leaf) it.priv_node = CHILD(it.priv_node, 0);
+    return it;
+}
+
+// Returns iterator to the greatest key, invalid one if map is empty
+// O(log n)
+#define btree_last(inst) RIFF_INST(btree_last, inst)
+
+RIFF_API(btree_iter(INSTANCE)) btree_last(INSTANCE)(const btree(INSTANCE)* tar) {
+    btree_iter(INSTANCE) it = { tar->priv_root, 0 };
+    if (it.priv_node) {
+        while (!it.priv_node->priv_leaf) it.priv_node = CHILD(it.priv_node, it.priv_node->priv_count);
+        it.priv_idx = it.priv_node->priv_count - 1u;
+    }
+    return it;
+}
+
+// Returns iterator to the first element with key not less than given one
+// Invalid iterator if there is no such element
+// O(log n)
+#define btree_lower_bound(inst) RIFF_INST(btree_lower_bound, inst)
+
+RIFF_API(btree_iter(INSTANCE)) btree_lower_bound(INSTANCE)(const btree(INSTANCE)* tar, KEY user_key) {
+    btree_iter(INSTANCE) best = { NULL, 0 };
+
+    NODE* n = tar->priv_root;
+    while (n) {
+        size_t i = RIFF_INST(btree_internal_search, INSTANCE)(n, &user_key);
+        if (i < n->priv_count) {
+            best.priv_node = n;
+            best.priv_idx  = i;
+            if (!LESS(&user_key, &n->priv_keys[i])) break; // exact match
+        }
+        n = n->priv_leaf ? NULL : CHILD(n, i);
+    }
+    return best;
+}
+
+// Returns iterator to the next element (in ascending key order)
+// Invalid iterator if it was the last one. Iterator must be valid
+// O(1) amortized, O(log n) worst
+#define btree_next(inst) RIFF_INST(btree_next, inst)
+
+RIFF_API(btree_iter(INSTANCE)) btree_next(INSTANCE)(btree_iter(INSTANCE) it) {
+    NODE* n = it.priv_node;
+
+    // go to the leftmost leaf of the right subtree
+    if (!n->priv_leaf) {
+        n = CHILD(n, it.priv_idx + 1);
+        while (!n->priv_leaf) n = CHILD(n, 0);
+        it.priv_node = n;
+        it.priv_idx  = 0;
+        return it;
+    }
+
+    if (it.priv_idx + 1 < n->priv_count) {
+        it.priv_idx++;
+        return it;
+    }
+
+    // climb until coming from a child which has a key on its right
+    while (n->priv_parent) {
+        size_t i = RIFF_INST(btree_internal_child_idx, INSTANCE)(n);
+        n = n->priv_parent;
+        if (i < n->priv_count) {
+            it.priv_node = n;
+            it.priv_idx  = i;
+            return it;
+        }
+    }
+
+    it.priv_node = NULL;
+    it.priv_idx  = 0;
+    return it;
+}
+
+// Returns iterator to the previous element (in ascending key order)
+// Invalid iterator if it was the first one. Iterator must be valid
+// O(1) amortized, O(log n) worst
+#define btree_prev(inst) RIFF_INST(btree_prev, inst)
+
+RIFF_API(btree_iter(INSTANCE)) btree_prev(INSTANCE)(btree_iter(INSTANCE) it) {
+    NODE* n = it.priv_node;
+
+    // go to the rightmost leaf of the left subtree
+    if (!n->priv_leaf) {
+        n = CHILD(n, it.priv_idx);
+        while (!n->priv_leaf) n = CHILD(n, n->priv_count);
+        it.priv_node = n;
+        it.priv_idx  = n->priv_count - 1u;
+        return it;
+    }
+
+    if (it.priv_idx > 0) {
+        it.priv_idx--;
+        return it;
+    }
+
+    // climb until coming from a child which has a key on its left
+    while (n->priv_parent) {
+        size_t i = RIFF_INST(btree_internal_child_idx, INSTANCE)(n);
+        n = n->priv_parent;
+        if (i > 0) {
+            it.priv_node = n;
+            it.priv_idx  = i - 1;
+            return it;
+        }
+    }
+
+    it.priv_node = NULL;
+    it.priv_idx  = 0;
+    return it;
+}
+
+#undef CHILD
+#undef KEY_DESTROY
+#undef VAL_DESTROY
+#undef NODE
+#undef INNER
+
+#undef NODE_FIT
+#undef NODE_CAPC
+#undef MIN_KEYS
+
+#undef INSTANCE
+#undef KEY
+#undef KEY_DEST
+#undef VAL
+#undef VAL_DEST
+#undef LESS
+#undef NODE_BYTES
+#undef TRIVIAL
+
+// consume parameters
+#undef T
+#undef A
@@ -1,6 +1,9 @@
 /*
     T macro pattern
         [instance name], [stored type], [stored type destructor (opt)]
+
+    Without destructor the stored type is trivial, element destruction is compiled out
+    Define RIFF_STATS before inclusion to collect counters, see dlist_stats()
 */
 
 #include "generic.h"
@@ -20,6 +23,36 @@
 #define INSTANCE   RIFF_FIRST(T)
 #define STORED     RIFF_SECOND(T)
 #define DESTRUCTOR RIFF_THIRD(T)
+#define TRIVIAL    RIFF_IS_EMPTY(DESTRUCTOR)
+
+#if TRIVIAL
+    #define DESTROY(ptr)
+#else
+    #define DESTROY(ptr) DESTRUCTOR(ptr)
+#endif
+
+#ifdef RIFF_STATS
+    #define STAT(...) __VA_ARGS__
+#else
+    #define STAT(...)
+#endif
+
+#define STAT_NODE(tar) STAT( \
+    (tar)->priv_stats.node_allocs++; \
+    (tar)->priv_stats.bytes_allocated += sizeof(dlist_node(INSTANCE)); \
+    if ((tar)->priv_size > (tar)->priv_stats.peak_size) (tar)->priv_stats.peak_size = (tar)->priv_size; \
+)
+
+#if defined(RIFF_STATS) && !defined(RIFF_DLIST_STATS)
+#define RIFF_DLIST_STATS
+
+// Doubly linked list counters, collected when RIFF_STATS is defined
+typedef struct riff_dlist_stats {
+    size_t node_allocs;     // nodes allocated in total
+    size_t bytes_allocated; // bytes requested from the allocator in total
+    size_t peak_size;       // highest count of elements
+} riff_dlist_stats;
+#endif
 
 /*
     Typedef
@@ -42,6 +75,9 @@ typedef struct dlist(INSTANCE) {
     size_t          priv_size;
     dlist_node(INSTANCE)*  priv_first;
     dlist_node(INSTANCE)*  priv_last;
+#ifdef RIFF_STATS
+    riff_dlist_stats priv_stats;
+#endif
 } dlist(INSTANCE);
 
 /*
@@ -56,6 +92,7 @@ RIFF_API(void) dlist_zero(INSTANCE)(dlist(INSTANCE)* tar) {
     tar->priv_size  = 0;
     tar->priv_first = NULL;
     tar->priv_last  = NULL;
+    STAT(riff_dlist_stats zero_stats = { 0 }; tar->priv_stats = zero_stats;)
 }
 
 
@@ -66,7 +103,7 @@ RIFF_API(void) dlist_destroy(INSTANCE)(dlist(INSTANCE)* tar) {
     dlist_node(INSTANCE)* cur = tar->priv_first;
     while (cur) {
         dlist_node(INSTANCE)* next = cur->priv_next;
-        DESTRUCTOR(&cur->priv_obj); // destroy object
+        DESTROY(&cur->priv_obj); // destroy object
         RIFF_FREE(cur); // free node
         cur = next;
     }
@@ -192,6 +229,7 @@ RIFF_API(dlist_node(INSTANCE)*) dlist_push_before(INSTANCE)(
     }
 
     tar->priv_size++;
+    STAT_NODE(tar);
     return new_node;
 }
 
@@ -235,6 +273,7 @@ RIFF_API(dlist_node(INSTANCE)*) dlist_push_after(INSTANCE)(
     }
 
     tar->priv_size++;
+    STAT_NODE(tar);
     return new_node;
 }
 
@@ -248,7 +287,7 @@ RIFF_API(dlist_node(INSTANCE)*) dlist_push_after(INSTANCE)(
 RIFF_API(void) dlist_pop(INSTANCE)(dlist(INSTANCE)* tar, dlist_node(INSTANCE)* n, STORED* out) {
     // get rid of object
     if (out) *out = n->priv_obj;
-    else DESTRUCTOR(&n->priv_obj);
+    else { DESTROY(&n->priv_obj); }
 
     // Relink previous node
     if (n->priv_prev) n->priv_prev->priv_next = n->priv_next;
@@ -269,12 +308,34 @@ RIFF_API(void) dlist_pop(INSTANCE)(dlist(INSTANCE)* tar, dlist_node(INSTANCE)* n
 #define dlist_clear(inst) RIFF_INST(dlist_clear, inst)
 
 RIFF_API(void) dlist_clear(INSTANCE)(dlist(INSTANCE)* tar) {
+    STAT(riff_dlist_stats stats = tar->priv_stats;)
     dlist_destroy(INSTANCE)(tar); // apparently the same
+    STAT(tar->priv_stats = stats;)
 }
 
+#ifdef RIFF_STATS
+/*
+    Statistics
+*/
+
+// Returns counters collected since the list was zeroed / destroyed
+// Only defined when RIFF_STATS is defined before inclusion
+// O(1)
+#define dlist_stats(inst) RIFF_INST(dlist_stats, inst)
+
+RIFF_API(riff_dlist_stats) dlist_stats(INSTANCE)(const dlist(INSTANCE)* tar) {
+    return tar->priv_stats;
+}
+#endif
+
+#undef DESTROY
+#undef STAT
+#undef STAT_NODE
+
 #undef INSTANCE
 #undef STORED
 #undef DESTRUCTOR
+#undef TRIVIAL
 
 // consume parameters
 #undef T
@@ -1,10 +1,16 @@
 /*
     T macro pattern
         [instance name], [stored type], [stored type destructor (opt)]
+
+    Without destructor the stored type is trivial, element destruction loops are compiled out
+    Elements are moved with memcpy, as every stored object is (shallow copy ownership)
+    Define RIFF_STATS before inclusion to collect counters, see dyarr_stats()
 */
 
 #include "generic.h"
 
+#include <string.h>
+
 #ifndef T
     #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
 #endif
@@ -20,9 +26,36 @@
 #define INSTANCE   RIFF_FIRST(T)
 #define STORED     RIFF_SECOND(T)
 #define DESTRUCTOR RIFF_THIRD(T)
+#define TRIVIAL    RIFF_IS_EMPTY(DESTRUCTOR)
+
+#if TRIVIAL
+    #define DESTROY(ptr)
+    #define DESTRUCTOR_LOOP(beg, end)
+#else
+    #define DESTROY(ptr) DESTRUCTOR(ptr)
+    #define DESTRUCTOR_LOOP(beg, end) \
+        for (STORED* ptr = beg; ptr < end; ptr++) DESTRUCTOR(ptr);
+#endif
+
+#ifdef RIFF_STATS
+    #define STAT(...) __VA_ARGS__
+#else
+    #define STAT(...)
+#endif
+
+#define STAT_REALLOC(arr, bytes) STAT((arr)->priv_stats.reallocs++; (arr)->priv_stats.bytes_allocated += (bytes);)
+#define STAT_PEAK(arr) STAT(if ((arr)->priv_size > (arr)->priv_stats.peak_size) (arr)->priv_stats.peak_size = (arr)->priv_size;)
 
-#define DESTRUCTOR_LOOP(beg, end) \
-    for (STORED* ptr = beg; ptr < end; ptr++) DESTRUCTOR(ptr);
+#if defined(RIFF_STATS) && !defined(RIFF_DYARR_STATS)
+#define RIFF_DYARR_STATS
+
+// Dynamic array counters, collected when RIFF_STATS is defined
+typedef struct riff_dyarr_stats {
+    size_t reallocs;        // successful allocator calls
+    size_t bytes_allocated; // bytes requested from the allocator in total
+    size_t peak_size;       // highest count of elements
+} riff_dyarr_stats;
+#endif
 
 /*
     Typedef
@@ -38,6 +71,9 @@ typedef struct dyarr(INSTANCE) {
     size_t  priv_size;
     size_t  priv_capc;
     STORED* priv_data;
+#ifdef RIFF_STATS
+    riff_dyarr_stats priv_stats;
+#endif
 } dyarr(INSTANCE);
 
 /*
@@ -52,6 +88,7 @@ RIFF_API(void) dyarr_zero(INSTANCE)(dyarr(INSTANCE)* tar) {
     tar->priv_size = 0;
     tar->priv_capc = 0;
     tar->priv_data = 0;
+    STAT(riff_dyarr_stats zero_stats = { 0 }; tar->priv_stats = zero_stats;)
 }
 
 // Properly destroys given dynamic array
@@ -78,6 +115,7 @@ RIFF_API(int) dyarr_reserve(INSTANCE)(dyarr(INSTANCE)* arr, size_t capacity) {
     // realloc into bigger block
     STORED* new_data = (STORED*)RIFF_REALLOC(arr->priv_data, capacity * sizeof(STORED));
     if (!new_data) return ERR; // realloc failed
+    STAT_REALLOC(arr, capacity * sizeof(STORED));
 
     arr->priv_data = new_data;
     arr->priv_capc = capacity;
@@ -95,13 +133,16 @@ RIFF_API(int) dyarr_shrink_to_fit(INSTANCE)(dyarr(INSTANCE)* arr) {
 
     // fall to zero state
     if (new_cap == 0) {
+        STAT(riff_dyarr_stats stats = arr->priv_stats;)
         dyarr_destroy(INSTANCE)(arr);
+        STAT(arr->priv_stats = stats;)
         return SCC;
     }
     
     // realloc block
-    STORED* new_data = RIFF_REALLOC(arr->priv_data, new_cap * sizeof(STORED));
+    STORED* new_data = (STORED*)RIFF_REALLOC(arr->priv_data, new_cap * sizeof(STORED));
     if (!new_data) return ERR; // reallocation failed
+    STAT_REALLOC(arr, new_cap * sizeof(STORED));
 
     arr->priv_data = new_data;
     arr->priv_capc = new_cap;
@@ -163,15 +204,38 @@ RIFF_API(const STORED*) dyarr_const_access(INSTANCE)(const dyarr(INSTANCE)* arr)
 RIFF_API(int) dyarr_push(INSTANCE)(dyarr(INSTANCE)* arr, STORED value) {
     if (arr->priv_size >= arr->priv_capc) {
         size_t new_cap = arr->priv_capc ? arr->priv_capc * 2 : 1;
-        void* new_data = (STORED*)RIFF_REALLOC(arr->priv_data, new_cap * sizeof(STORED));
+        STORED* new_data = (STORED*)RIFF_REALLOC(arr->priv_data, new_cap * sizeof(STORED));
         if (!new_data) return ERR; // allocation failed
+        STAT_REALLOC(arr, new_cap * sizeof(STORED));
         arr->priv_capc = new_cap;
         arr->priv_data = new_data;
     }
     ((STORED*)arr->priv_data)[arr->priv_size++] = value;
+    STAT_PEAK(arr);
     return SCC;
 }
 
+// Grows dynamic array by amount elements, without initializing them
+// Returns pointer to the first new element, caller must initialize all of them
+// before the array is used again (destructor, if provided, will be called on them sooner or later)
+// Reserve beforehand to write into the tail first and extend afterwards without reallocation
+// May cause reallocation of dynamic array memory - watch out for your pointers
+// May fail (returns NULL), O(1) else reallocation time complexity
+#define dyarr_extend(inst) RIFF_INST(dyarr_extend, inst)
+
+RIFF_API(STORED*) dyarr_extend(INSTANCE)(dyarr(INSTANCE)* arr, size_t amount) {
+    if (arr->priv_size + amount > arr->priv_capc) {
+        size_t new_cap = arr->priv_capc * 2;
+        if (new_cap < arr->priv_size + amount) new_cap = arr->priv_size + amount;
+        if (dyarr_reserve(INSTANCE)(arr, new_cap) == ERR) return NULL; // allocation failed
+    }
+
+    STORED* first = arr->priv_data + arr->priv_size;
+    arr->priv_size += amount;
+    STAT_PEAK(arr);
+    return first;
+}
+
 // Pops last element of the dynamic array
 // If out is null destructor (if provided) will be called on the poped object
 // Else object will be moved into *out
@@ -185,7 +249,7 @@ RIFF_API(int) dyarr_pop(INSTANCE)(dyarr(INSTANCE)* arr, STORED* out) {
     // transfer to out
     if (out) *out = ((STORED*)arr->priv_data)[arr->priv_size];
     // destroy element
-    else DESTRUCTOR(&((STORED*)arr->priv_data)[arr->priv_size]);
+    else { DESTROY(&((STORED*)arr->priv_data)[arr->priv_size]); }
 
     return SCC;
 }
@@ -204,8 +268,8 @@ RIFF_API(int) dyarr_pop_many(INSTANCE)(dyarr(INSTANCE)* arr, STORED* out, size_t
 
     size_t first = arr->priv_size - amount;
 
-    if (out) for (size_t i = 0; i < amount; i++) out[i] = arr->priv_data[first + i];
-    else  DESTRUCTOR_LOOP(arr->priv_data + first, arr->priv_data + arr->priv_size);
+    if (out) { if (amount) memcpy(out, arr->priv_data + first, amount * sizeof(STORED)); }
+    else     { DESTRUCTOR_LOOP(arr->priv_data + first, arr->priv_data + arr->priv_size); }
 
     arr->priv_size = first;
     return SCC;
@@ -221,11 +285,31 @@ RIFF_API(void) dyarr_clear(INSTANCE)(dyarr(INSTANCE)* arr) {
     arr->priv_size = 0;
 }
 
+#ifdef RIFF_STATS
+/*
+    Statistics
+*/
+
+// Returns counters collected since the array was zeroed / destroyed
+// Only defined when RIFF_STATS is defined before inclusion
+// O(1)
+#define dyarr_stats(inst) RIFF_INST(dyarr_stats, inst)
+
+RIFF_API(riff_dyarr_stats) dyarr_stats(INSTANCE)(const dyarr(INSTANCE)* arr) {
+    return arr->priv_stats;
+}
+#endif
+
+#undef DESTROY
 #undef DESTRUCTOR_LOOP
+#undef STAT
+#undef STAT_REALLOC
+#undef STAT_PEAK
 
 #undef INSTANCE
 #undef STORED
 #undef DESTRUCTOR
+#undef TRIVIAL
 
 // consume parameters
 #undef T
@@ -0,0 +1,233 @@
+/*
+    T macro pattern
+        [instance name], [stored type],
+        [less function - int(func)(const STORED* a, const STORED* b) (non-0 if a < b)]
+
+    Immutable search array in Eytzinger (BFS) order, built once from a sorted buffer
+    e.g. the one of dyarr_const_access() / dyarr_size() after algo_sort()
+    Node k has children 2k and 2k + 1, so the first levels stay cached and the search is a
+    branchless descent, prefetching the cache line of the descendants a few levels ahead
+    Lookups return pointers to elements - store key / payload structs with a key-only less function
+    to use it as a read-only map
+    Stored type must be trivial, elements are copied bytewise and never destructed
+*/
+
+#include "generic.h"
+
+#include <stdint.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Helpers
+*/
+
+#ifndef RIFF_EYTZ_HELPERS
+#define RIFF_EYTZ_HELPERS
+
+// searches run in lockstep by eytz_lower_bound_many()
+#define RIFF_EYTZ_BATCH 8
+
+// Returns node of the descent end k, after its trailing right turns and the final left turn are undone
+// 0 if the descent only turned right
+// O(1)
+RIFF_API(size_t) riff_eytz_resolve(size_t k) {
+#if defined(__GNUC__)
+    return k >> (__builtin_ctzll(~(unsigned long long)k) + 1);
+#else
+    while (k & 1) k >>= 1;
+    return k >> 1;
+#endif
+}
+
+#endif // RIFF_EYTZ_HELPERS
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE RIFF_FIRST(T)
+#define STORED   RIFF_SECOND(T)
+#define LESS     RIFF_THIRD(T)
+
+// descendants this many times deeper share a cache line (64 byte aligned data)
+// rounded down to a power of two, only then k * AHEAD starts a whole level of descendants
+#define LINE_ELEMS (64 / sizeof(STORED))
+#define AHEAD      (LINE_ELEMS >= 64 ? 64 : LINE_ELEMS >= 32 ? 32 : LINE_ELEMS >= 16 ? 16 : \
+                    LINE_ELEMS >= 8 ? 8 : LINE_ELEMS >= 4 ? 4 : LINE_ELEMS >= 2 ? 2 : 1)
+
+// address of node k * AHEAD without forming an out of bounds pointer, prefetch does not fault
+#define PREFETCH_BELOW(tar, k) RIFF_PREFETCH((const void*)((uintptr_t)(tar)->priv_data + (k) * AHEAD * sizeof(STORED)))
+
+/*
+    Typedef
+*/
+
+// Eytzinger search array (eytz)
+// Elements in BFS order of the implicit complete binary search tree, node 1 is the root
+// O(log n) lower bound with O(log n / log line) cache misses, O(n) build
+// O(n) memory complexity
+#define eytz(inst) RIFF_INST(eytz, inst)
+
+typedef struct eytz(INSTANCE) {
+    STORED* priv_data; // 64 byte aligned, inside priv_mem, node k at priv_data[k] (priv_data[0] unused)
+    void*   priv_mem;
+    size_t  priv_size;
+} eytz(INSTANCE);
+
+/*
+    Zero / Destruction
+*/
+
+// Makes unitialized memory proper 0-initialized empty search array
+// Does not free anything
+#define eytz_zero(inst) RIFF_INST(eytz_zero, inst)
+
+RIFF_API(void) eytz_zero(INSTANCE)(eytz(INSTANCE)* tar) {
+    tar->priv_data = NULL;
+    tar->priv_mem  = NULL;
+    tar->priv_size = 0;
+}
+
+// Frees the elements
+// O(1)
+#define eytz_destroy(inst) RIFF_INST(eytz_destroy, inst)
+
+RIFF_API(void) eytz_destroy(INSTANCE)(eytz(INSTANCE)* tar) {
+    RIFF_FREE(tar->priv_mem);
+    eytz_zero(INSTANCE)(tar);
+}
+
+/*
+    Build
+*/
+
+// Replaces content with copies of size elements of the sorted buffer
+// May fail (allocation, buffer not sorted), O(n)
+#define eytz_build(inst) RIFF_INST(eytz_build, inst)
+
+RIFF_API(int) eytz_build(INSTANCE)(eytz(INSTANCE)* tar, const STORED* sorted, size_t size) {
+    for (size_t i = 1; i < size; i++) if (LESS(&sorted[i], &sorted[i - 1])) return ERR;
+    if (size >= (SIZE_MAX - 64) / sizeof(STORED)) return ERR;
+
+    // node 0 unused, spare bytes for the alignment
+    void* mem = RIFF_ALLOC((size + 1) * sizeof(STORED) + 64);
+    if (!mem) return ERR;
+    RIFF_FREE(tar->priv_mem);
+
+    STORED* data = (STORED*)(((uintptr_t)mem + 63) & ~(uintptr_t)63);
+
+    // in-order walk of the implicit tree takes the sorted elements in order
+    size_t k = 1;
+    while (2 * k <= size) k *= 2;
+    for (size_t i = 0; i < size; i++) {
+        data[k] = sorted[i];
+        if (2 * k + 1 <= size) {
+            k = 2 * k + 1;
+            while (2 * k <= size) k *= 2;
+        }
+        else k = riff_eytz_resolve(k);
+    }
+
+    tar->priv_data = data;
+    tar->priv_mem  = mem;
+    tar->priv_size = size;
+    return SCC;
+}
+
+/*
+    Query
+*/
+
+// Returns count of elements
+// O(1)
+#define eytz_size(inst) RIFF_INST(eytz_size, inst)
+
+RIFF_API(size_t) eytz_size(INSTANCE)(const eytz(INSTANCE)* tar) {
+    return tar->priv_size;
+}
+
+// Returns pointer to the smallest element not less than value, NULL if there is none
+// Branchless, O(log n)
+#define eytz_lower_bound(inst) RIFF_INST(eytz_lower_bound, inst)
+
+RIFF_API(const STORED*) eytz_lower_bound(INSTANCE)(const eytz(INSTANCE)* tar, const STORED* value) {
+    size_t k = 1;
+    while (k <= tar->priv_size) {
+        PREFETCH_BELOW(tar, k);
+        k = 2 * k + (LESS(&tar->priv_data[k], value) ? 1 : 0);
+    }
+    k = riff_eytz_resolve(k);
+    return k ? &tar->priv_data[k] : NULL;
+}
+
+// Returns pointer to the smallest element greater than value, NULL if there is none
+// Branchless, O(log n)
+#define eytz_upper_bound(inst) RIFF_INST(eytz_upper_bound, inst)
+
+RIFF_API(const STORED*) eytz_upper_bound(INSTANCE)(const eytz(INSTANCE)* tar, const STORED* value) {
+    size_t k = 1;
+    while (k <= tar->priv_size) {
+        PREFETCH_BELOW(tar, k);
+        k = 2 * k + (LESS(value, &tar->priv_data[k]) ? 0 : 1);
+    }
+    k = riff_eytz_resolve(k);
+    return k ? &tar->priv_data[k] : NULL;
+}
+
+// Returns pointer to an element equal to value (neither less nor greater), NULL if there is none
+// O(log n)
+#define eytz_find(inst) RIFF_INST(eytz_find, inst)
+
+RIFF_API(const STORED*) eytz_find(INSTANCE)(const eytz(INSTANCE)* tar, const STORED* value) {
+    const STORED* found = eytz_lower_bound(INSTANCE)(tar, value);
+    return found && !LESS(value, found) ? found : NULL;
+}
+
+// Sets out[i] as eytz_lower_bound() of values[i] would return, for count values
+// Batches of searches descend in lockstep, so their cache misses overlap
+// O(count log n)
+#define eytz_lower_bound_many(inst) RIFF_INST(eytz_lower_bound_many, inst)
+
+RIFF_API(void) eytz_lower_bound_many(INSTANCE)(const eytz(INSTANCE)* tar, const STORED* values, size_t count, const STORED** out) {
+    size_t n    = tar->priv_size;
+    size_t full = 0; // levels every descent takes, the last level may be partial
+    while (((size_t)2 << full) - 1 <= n) full++;
+
+    size_t ks[RIFF_EYTZ_BATCH];
+    for (size_t i = 0; i < count; i += RIFF_EYTZ_BATCH) {
+        size_t batch = count - i < RIFF_EYTZ_BATCH ? count - i : RIFF_EYTZ_BATCH;
+
+        for (size_t j = 0; j < batch; j++) ks[j] = 1;
+        for (size_t level = 0; level < full; level++) {
+            for (size_t j = 0; j < batch; j++) {
+                PREFETCH_BELOW(tar, ks[j]);
+                ks[j] = 2 * ks[j] + (LESS(&tar->priv_data[ks[j]], &values[i + j]) ? 1 : 0);
+            }
+        }
+        for (size_t j = 0; j < batch; j++) {
+            size_t k = ks[j];
+            if (k <= n) k = 2 * k + (LESS(&tar->priv_data[k], &values[i + j]) ? 1 : 0);
+            k = riff_eytz_resolve(k);
+            out[i + j] = k ? &tar->priv_data[k] : NULL;
+        }
+    }
+}
+
+#undef LINE_ELEMS
+#undef AHEAD
+#undef PREFETCH_BELOW
+
+#undef INSTANCE
+#undef STORED
+#undef LESS
+
+// consume parameters
+#undef T
+#undef A
@@ -36,12 +36,35 @@
 #define RIFF_CAT_IMPL(a, b) a##b
 #define RIFF_CAT(a, b)  RIFF_CAT_IMPL(a, b)
 
+// for detecting empty (omitted) optional T macro slots, usable inside #if
+// RIFF_IS_EMPTY(x) is 1 when x expands to nothing, 0 otherwise (x must be an identifier / number)
+#define RIFF_PROBE_IMPL(x, n, ...) n
+#define RIFF_PROBE(...) RIFF_PROBE_IMPL(__VA_ARGS__, 0, ~)
+#define RIFF_EMPTY_PROBE_ ~, 1
+#define RIFF_IS_EMPTY_IMPL(x) RIFF_PROBE(RIFF_EMPTY_PROBE_ ## x)
+#define RIFF_IS_EMPTY(x) RIFF_IS_EMPTY_IMPL(x)
+
+// for choosing between two alternatives based on a 0 / 1 condition
+#define RIFF_IF_0(t, f) f
+#define RIFF_IF_1(t, f) t
+#define RIFF_IF(c) RIFF_CAT(RIFF_IF_, c)
+
+// for giving optional T macro slots default values
+#define RIFF_OR_DEFAULT(x, def) RIFF_IF(RIFF_IS_EMPTY(x))(def, x)
+
 // for making instances-names
 #define RIFF_INST(thing, instance_name) RIFF_CAT(RIFF_CAT(riff_implementation_of_, thing), RIFF_CAT(_for_, instance_name))
 
 // for defining functions
 #define RIFF_API(ret) static inline ret
 
+// for prefetching the cache line of an address, no-op where unsupported (never faults)
+#if defined(__GNUC__)
+    #define RIFF_PREFETCH(ptr) __builtin_prefetch(ptr)
+#else
+    #define RIFF_PREFETCH(ptr) ((void)0)
+#endif
+
 // success flag
 #define SCC 1
 
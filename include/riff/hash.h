@@ -0,0 +1,231 @@
+/*
+    Hash functions
+
+    Not a T macro header - include it anywhere, as many times as needed
+    riff_hash_bytes()  - wyhash style (128 bit multiply-mix) hash of byte strings, fast for short and long keys
+    riff_mix64/32()    - integer finalizers, every input bit affects every output bit
+    *_seeded variants  - take a seed, keeping collisions unpredictable without it (HashDoS resistance)
+
+    Ready-made hash / equal pairs with the signatures hhmap expects, e.g.
+        #define T ids, uint64_t, , my_val, , riff_hash_u64, riff_equal_u64
+    They hash with RIFF_HASH_SEED, 0 by default. Define it before the first inclusion,
+    e.g. to a global variable set from a random source at startup, to seed every map
+*/
+
+#ifndef RIFF_HASH_H
+#define RIFF_HASH_H
+
+#include "generic.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef RIFF_HASH_SEED
+    #define RIFF_HASH_SEED 0
+#endif
+
+/*
+    Primitives
+*/
+
+#define RIFF_HASH_S0 0xa0761d6478bd642full
+#define RIFF_HASH_S1 0xe7037ed1a0b428dbull
+#define RIFF_HASH_S2 0x8ebc6af09c88c6e3ull
+#define RIFF_HASH_S3 0x589965cc75374cc3ull
+
+// 64 x 64 -> 128 bit multiplication, low half into *a, high half into *b
+RIFF_API(void) riff_hash_internal_mum(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 r = (unsigned __int128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t  = rl + (rm0 << 32);
+    uint64_t c  = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+RIFF_API(uint64_t) riff_hash_internal_mix(uint64_t a, uint64_t b) {
+    riff_hash_internal_mum(&a, &b);
+    return a ^ b;
+}
+
+// unaligned little-endian reads (memcpy compiles to single loads)
+RIFF_API(uint64_t) riff_hash_internal_r8(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+RIFF_API(uint64_t) riff_hash_internal_r4(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// 1 - 3 bytes
+RIFF_API(uint64_t) riff_hash_internal_r3(const uint8_t* p, size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+/*
+    Hashes
+*/
+
+// Hashes len bytes of data with given seed
+// O(len)
+RIFF_API(uint64_t) riff_hash_bytes(const void* data, size_t len, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t a, b;
+
+    seed ^= riff_hash_internal_mix(seed ^ RIFF_HASH_S0, RIFF_HASH_S1);
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t off = (len >> 3) << 2;
+            a = (riff_hash_internal_r4(p) << 32) | riff_hash_internal_r4(p + off);
+            b = (riff_hash_internal_r4(p + len - 4) << 32) | riff_hash_internal_r4(p + len - 4 - off);
+        }
+        else if (len > 0) {
+            a = riff_hash_internal_r3(p, len);
+            b = 0;
+        }
+        else a = b = 0;
+    }
+    else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = riff_hash_internal_mix(riff_hash_internal_r8(p)      ^ RIFF_HASH_S1, riff_hash_internal_r8(p + 8)  ^ seed);
+                see1 = riff_hash_internal_mix(riff_hash_internal_r8(p + 16) ^ RIFF_HASH_S2, riff_hash_internal_r8(p + 24) ^ see1);
+                see2 = riff_hash_internal_mix(riff_hash_internal_r8(p + 32) ^ RIFF_HASH_S3, riff_hash_internal_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = riff_hash_internal_mix(riff_hash_internal_r8(p) ^ RIFF_HASH_S1, riff_hash_internal_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = riff_hash_internal_r8(p + i - 16);
+        b = riff_hash_internal_r8(p + i - 8);
+    }
+
+    a ^= RIFF_HASH_S1;
+    b ^= seed;
+    riff_hash_internal_mum(&a, &b);
+    return riff_hash_internal_mix(a ^ RIFF_HASH_S0 ^ len, b ^ RIFF_HASH_S1);
+}
+
+// Hashes NUL-terminated string (without the terminator) with given seed
+// O(len)
+RIFF_API(uint64_t) riff_hash_cstring(const char* str, uint64_t seed) {
+    return riff_hash_bytes(str, strlen(str), seed);
+}
+
+// 64 bit finalizer (murmur3 fmix64), bijective
+// O(1)
+RIFF_API(uint64_t) riff_mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// 32 bit finalizer (lowbias32), bijective
+// O(1)
+RIFF_API(uint32_t) riff_mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Seeded 64 bit integer hash
+// O(1)
+RIFF_API(uint64_t) riff_mix64_seeded(uint64_t x, uint64_t seed) {
+    uint64_t a = x ^ RIFF_HASH_S0, b = seed ^ RIFF_HASH_S1;
+    riff_hash_internal_mum(&a, &b);
+    return riff_hash_internal_mix(a ^ RIFF_HASH_S0, b ^ RIFF_HASH_S1);
+}
+
+/*
+    Hash / equal pairs for hhmap
+*/
+
+RIFF_API(size_t) riff_hash_u64(const uint64_t* k) {
+    return (size_t)(RIFF_HASH_SEED ? riff_mix64_seeded(*k, RIFF_HASH_SEED) : riff_mix64(*k));
+}
+
+RIFF_API(int) riff_equal_u64(const uint64_t* a, const uint64_t* b) {
+    return *a == *b;
+}
+
+RIFF_API(size_t) riff_hash_i64(const int64_t* k) {
+    uint64_t u = (uint64_t)*k;
+    return riff_hash_u64(&u);
+}
+
+RIFF_API(int) riff_equal_i64(const int64_t* a, const int64_t* b) {
+    return *a == *b;
+}
+
+RIFF_API(size_t) riff_hash_u32(const uint32_t* k) {
+    return (size_t)(RIFF_HASH_SEED ? riff_mix64_seeded(*k, RIFF_HASH_SEED) : riff_mix64(*k));
+}
+
+RIFF_API(int) riff_equal_u32(const uint32_t* a, const uint32_t* b) {
+    return *a == *b;
+}
+
+RIFF_API(size_t) riff_hash_i32(const int32_t* k) {
+    uint32_t u = (uint32_t)*k;
+    return riff_hash_u32(&u);
+}
+
+RIFF_API(int) riff_equal_i32(const int32_t* a, const int32_t* b) {
+    return *a == *b;
+}
+
+// void* keys as identities (address is hashed, not the pointee)
+RIFF_API(size_t) riff_hash_ptr(void* const* k) {
+    uint64_t u = (uint64_t)(uintptr_t)*k;
+    return riff_hash_u64(&u);
+}
+
+RIFF_API(int) riff_equal_ptr(void* const* a, void* const* b) {
+    return *a == *b;
+}
+
+// NUL-terminated char* keys, compared by content
+RIFF_API(size_t) riff_hash_str(char* const* k) {
+    return (size_t)riff_hash_cstring(*k, RIFF_HASH_SEED);
+}
+
+RIFF_API(int) riff_equal_str(char* const* a, char* const* b) {
+    return strcmp(*a, *b) == 0;
+}
+
+// NUL-terminated const char* keys, compared by content
+RIFF_API(size_t) riff_hash_cstr(const char* const* k) {
+    return (size_t)riff_hash_cstring(*k, RIFF_HASH_SEED);
+}
+
+RIFF_API(int) riff_equal_cstr(const char* const* a, const char* const* b) {
+    return strcmp(*a, *b) == 0;
+}
+
+#endif // RIFF_HASH_H
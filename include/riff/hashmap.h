@@ -5,10 +5,18 @@
         [stored type], [stored type destructor (opt)],
         [key type hash function - size_t(func)(const KEY*)]
         [key type equal function - int(func)(const KEY* a, const KEY* b) (non-0 if equal)]
+
+    Without both destructors the entries are trivial, destruction loops are compiled out
+    and clearing is a single memset
+    Rehash moves entries into the new arrays directly, without hash map pushes or equal calls
+
+    Define RIFF_STATS before inclusion to collect counters, see hhmap_stats()
 */
 
 #include "generic.h"
 
+#include <string.h>
+
 #ifndef T
     #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
 #endif
@@ -28,6 +36,19 @@
 #define VAL_DEST RIFF_FIFTH(T)
 #define HASH     RIFF_SIXTH(T)
 #define EQUAL    RIFF_SEVENTH(T)
+#define TRIVIAL  (RIFF_IS_EMPTY(KEY_DEST) && RIFF_IS_EMPTY(VAL_DEST))
+
+#if RIFF_IS_EMPTY(KEY_DEST)
+    #define KEY_DESTROY(ptr)
+#else
+    #define KEY_DESTROY(ptr) KEY_DEST(ptr)
+#endif
+
+#if RIFF_IS_EMPTY(VAL_DEST)
+    #define VAL_DESTROY(ptr)
+#else
+    #define VAL_DESTROY(ptr) VAL_DEST(ptr)
+#endif
 
 #define HASH_NONE 0
 #define HASH_FULL 1
@@ -35,6 +56,46 @@
 
 #define INIT_CAPC 16
 
+#define SLOT_BYTES (sizeof(char) + sizeof(KEY) + sizeof(VAL))
+
+#ifdef RIFF_STATS
+    #define STAT(...) __VA_ARGS__
+    #define EQ(tar, a, b) ((tar)->priv_stats.equal_calls++, EQUAL(a, b))
+#else
+    #define STAT(...)
+    #define EQ(tar, a, b) EQUAL(a, b)
+#endif
+
+// probe length of a push / find into the histogram
+#define STAT_PROBE(tar, len) STAT( \
+    (tar)->priv_stats.probe_hist[(len) < RIFF_HHMAP_PROBE_BUCKETS - 1 ? (len) : RIFF_HHMAP_PROBE_BUCKETS - 1]++; \
+)
+
+#if defined(RIFF_STATS) && !defined(RIFF_HHMAP_STATS)
+#define RIFF_HHMAP_STATS
+
+// probe length histogram buckets, the last one counts all longer probes
+#define RIFF_HHMAP_PROBE_BUCKETS 16
+
+// Hash map counters, collected when RIFF_STATS is defined
+// Probe length is the count of slots inspected past the home slot
+typedef struct riff_hhmap_stats {
+    size_t finds;           // hhmap_find calls
+    size_t find_hits;       // hhmap_find calls which found the key
+    size_t find_probes;     // probe lengths of hhmap_find calls summed up
+    size_t pushes;          // hhmap_push calls
+    size_t push_probes;     // probe lengths of hhmap_push calls summed up
+    size_t equal_calls;     // calls of the equal function
+    size_t rehashes;        // rebuilds of the arrays
+    size_t tombstones;      // slots currently holding a tombstone, filled by hhmap_stats()
+    size_t bytes_allocated; // bytes requested from the allocator in total
+    size_t peak_size;       // highest count of elements
+    size_t size;            // count of elements, filled by hhmap_stats()
+    size_t capacity;        // count of slots, filled by hhmap_stats()
+    size_t probe_hist[RIFF_HHMAP_PROBE_BUCKETS]; // probe lengths of finds and pushes
+} riff_hhmap_stats;
+#endif
+
 /*
     Typedef
 */
@@ -49,8 +110,12 @@ typedef struct hhmap(INSTANCE) {
     char*   priv_used;
     KEY*    priv_keys;
     VAL*    priv_values;
-    size_t  priv_size; // actual count of items within
-    size_t  priv_capc; // size of arrays
+    size_t  priv_size;  // actual count of items within
+    size_t  priv_tombs; // count of tombstones, they lengthen probes as items do
+    size_t  priv_capc;  // size of arrays
+#ifdef RIFF_STATS
+    riff_hhmap_stats priv_stats;
+#endif
 } hhmap(INSTANCE);
 
 /*
@@ -66,7 +131,9 @@ RIFF_API(void) RIFF_INST(hhmap_zero, INSTANCE)(hhmap(INSTANCE)* tar) {
     tar->priv_keys   = 0;
     tar->priv_values = 0;
     tar->priv_size   = 0;
+    tar->priv_tombs  = 0;
     tar->priv_capc   = 0;
+    STAT(riff_hhmap_stats zero_stats = { 0 }; tar->priv_stats = zero_stats;)
 }
 
 // Frees hashhmap and its keys and values
@@ -75,12 +142,14 @@ RIFF_API(void) RIFF_INST(hhmap_zero, INSTANCE)(hhmap(INSTANCE)* tar) {
 
 RIFF_API(void) RIFF_INST(hhmap_destroy, INSTANCE)(hhmap(INSTANCE) *tar) {
     // call destructors
+#if !TRIVIAL
     for (size_t i = 0; i < tar->priv_capc; i++) {
         if (tar->priv_used[i] == HASH_FULL) {
-            KEY_DEST(&tar->priv_keys[i]);
-            VAL_DEST(&tar->priv_values[i]);
+            KEY_DESTROY(&tar->priv_keys[i]);
+            VAL_DESTROY(&tar->priv_values[i]);
         }
     }
+#endif
 
     // free memory
     if (tar->priv_used)   RIFF_FREE(tar->priv_used);
@@ -95,8 +164,9 @@ RIFF_API(void) RIFF_INST(hhmap_destroy, INSTANCE)(hhmap(INSTANCE) *tar) {
 */
 
 RIFF_API(int) RIFF_INST(hhmap_internal_alloc, INSTANCE)(hhmap(INSTANCE)* tar, size_t cap) {
-    tar->priv_size = 0;
-    tar->priv_capc = cap;
+    tar->priv_size  = 0;
+    tar->priv_tombs = 0;
+    tar->priv_capc  = cap;
 
     tar->priv_used   = (char*)RIFF_ALLOC(tar->priv_capc * sizeof(char));
     tar->priv_keys   = (KEY*) RIFF_ALLOC(tar->priv_capc * sizeof(KEY));
@@ -109,35 +179,40 @@ RIFF_API(int) RIFF_INST(hhmap_internal_alloc, INSTANCE)(hhmap(INSTANCE)* tar, si
         return ERR;
     }
 
-    for (size_t i = 0; i < tar->priv_capc; ++i) tar->priv_used[i] = HASH_NONE;
+    memset(tar->priv_used, HASH_NONE, tar->priv_capc * sizeof(char));
     return SCC;
 }
 
-RIFF_API(int) RIFF_INST(hhmap_push, INSTANCE)(hhmap(INSTANCE)* tar, KEY key, VAL value); // forward
-
 // Rebuild internal arrays inside hashhmap
 // May fail (new_capacity to small to fit, or allocation failure), O(n)
 #define hhmap_rehash(inst) RIFF_INST(hhmap_rehash, inst)
 
 RIFF_API(int) RIFF_INST(hhmap_rehash, INSTANCE)(hhmap(INSTANCE)* tar, size_t new_capacity) {
     // null state now, just alloc
-    if (tar->priv_capc == 0) return RIFF_INST(hhmap_internal_alloc, INSTANCE)(tar, new_capacity);
+    if (tar->priv_capc == 0) {
+        if (RIFF_INST(hhmap_internal_alloc, INSTANCE)(tar, new_capacity) == ERR) return ERR;
+        STAT(tar->priv_stats.bytes_allocated += new_capacity * SLOT_BYTES;)
+        return SCC;
+    }
 
     // alloc new map
     if (new_capacity < tar->priv_size) return ERR;
-    hhmap(INSTANCE) new_map; if (RIFF_INST(hhmap_internal_alloc, INSTANCE)(&new_map, new_capacity) == ERR) return ERR;
+    hhmap(INSTANCE) new_map; RIFF_INST(hhmap_zero, INSTANCE)(&new_map);
+    if (RIFF_INST(hhmap_internal_alloc, INSTANCE)(&new_map, new_capacity) == ERR) return ERR;
 
-    // reinsert items into new map
+    // scatter items into new map, keys are unique and there are no tombstones
+    // so the first empty slot of the probe sequence is the place, cannot fail
     for (size_t i = 0; i < tar->priv_capc; ++i) {
         if (tar->priv_used[i] != HASH_FULL) continue;
-        int scc = RIFF_INST(hhmap_push, INSTANCE)(&new_map, tar->priv_keys[i], tar->priv_values[i]);
-        
-        // if failed to insert, destroy partialy created nao
-        if (scc != SCC) {
-            RIFF_INST(hhmap_destroy, INSTANCE)(&new_map);
-            return ERR;
-        }
+
+        size_t pos = HASH(&tar->priv_keys[i]) % new_capacity;
+        while (new_map.priv_used[pos] != HASH_NONE) pos = (pos + 1) % new_capacity;
+
+        new_map.priv_used[pos]   = HASH_FULL;
+        new_map.priv_keys[pos]   = tar->priv_keys[i];
+        new_map.priv_values[pos] = tar->priv_values[i];
     }
+    new_map.priv_size = tar->priv_size;
 
     // delete old arrays
     // do not use hhmap_destroy not to call destructors
@@ -145,7 +220,12 @@ RIFF_API(int) RIFF_INST(hhmap_rehash, INSTANCE)(hhmap(INSTANCE)* tar, size_t new
     RIFF_FREE(tar->priv_keys);
     RIFF_FREE(tar->priv_values);
 
-    // if everything succeded move new map into old map
+    // move new map into old map
+    STAT(
+        new_map.priv_stats                  = tar->priv_stats;
+        new_map.priv_stats.rehashes        += 1;
+        new_map.priv_stats.bytes_allocated += new_capacity * SLOT_BYTES;
+    )
     *tar = new_map;
     return SCC;
 }
@@ -164,24 +244,30 @@ RIFF_API(int) RIFF_INST(hhmap_push, INSTANCE)(hhmap(INSTANCE)* tar, KEY key, VAL
     if (tar->priv_capc == 0) {
         int scc = RIFF_INST(hhmap_internal_alloc, INSTANCE)(tar, INIT_CAPC);
         if (scc == ERR) return ERR; // allocation failed
+        STAT(tar->priv_stats.bytes_allocated += INIT_CAPC * SLOT_BYTES;)
     }
 
-    // Double memory if load factor exceeds 0.7
-    if ((tar->priv_size + 1) * 10 > tar->priv_capc * 7) {
-        // grow, if grow fails try to fit anyway - there still may be some free spots in the array
-        RIFF_INST(hhmap_rehash, INSTANCE)(tar, tar->priv_capc * 2);
+    // Rebuild if load factor (items and tombstones) exceeds 0.7
+    // double memory if items alone exceed half of that, else only drop the tombstones
+    if ((tar->priv_size + tar->priv_tombs + 1) * 10 > tar->priv_capc * 7) {
+        size_t new_capacity = (tar->priv_size + 1) * 20 > tar->priv_capc * 7 ? tar->priv_capc * 2 : tar->priv_capc;
+        // if rebuild fails try to fit anyway - there still may be some free spots in the array
+        RIFF_INST(hhmap_rehash, INSTANCE)(tar, new_capacity);
     }
 
     size_t idx = HASH(&key) % tar->priv_capc;
     size_t first_tombstone = (size_t)(-1);
+    STAT(tar->priv_stats.pushes++;)
 
     for (size_t i = 0; i < tar->priv_capc; ++i) {
         size_t pos = (idx + i) % tar->priv_capc;
 
         // check if key is exactly the same, if so replace value
-        if (tar->priv_used[pos] == HASH_FULL && EQUAL(&tar->priv_keys[pos], &key)) {
-            KEY_DEST(&tar->priv_keys[pos]);   // free old key
-            VAL_DEST(&tar->priv_values[pos]); // free old value
+        if (tar->priv_used[pos] == HASH_FULL && EQ(tar, &tar->priv_keys[pos], &key)) {
+            STAT(tar->priv_stats.push_probes += i;)
+            STAT_PROBE(tar, i);
+            KEY_DESTROY(&tar->priv_keys[pos]);   // free old key
+            VAL_DESTROY(&tar->priv_values[pos]); // free old value
             tar->priv_keys[pos]   = key;
             tar->priv_values[pos] = value;
             return SCC;
@@ -193,11 +279,15 @@ RIFF_API(int) RIFF_INST(hhmap_push, INSTANCE)(hhmap(INSTANCE)* tar, KEY key, VAL
         // insert at first tombstone if available, else at empty slot
         else if (tar->priv_used[pos] == HASH_NONE) {  
             size_t insert_pos = (first_tombstone != (size_t)(-1)) ? first_tombstone : pos;
+            if (insert_pos != pos) tar->priv_tombs--;
+            STAT(tar->priv_stats.push_probes += i;)
+            STAT_PROBE(tar, i);
 
             tar->priv_used[insert_pos]   = HASH_FULL;
             tar->priv_keys[insert_pos]   = key;
             tar->priv_values[insert_pos] = value;
             tar->priv_size++;
+            STAT(if (tar->priv_size > tar->priv_stats.peak_size) tar->priv_stats.peak_size = tar->priv_size;)
 
             return SCC;
         }
@@ -219,21 +309,29 @@ RIFF_API(int) RIFF_INST(hhmap_find, INSTANCE)(hhmap(INSTANCE)* tar, KEY user_key
     if (tar->priv_capc == 0) return ERR; // empty map -> nothing can be found
 
     size_t idx = HASH(&user_key) % tar->priv_capc;
+    STAT(tar->priv_stats.finds++;)
     for (size_t i = 0; i < tar->priv_capc; ++i) {
         size_t pos = (idx + i) % tar->priv_capc;
 
         // none -> no such key
-        if (tar->priv_used[pos] == HASH_NONE)
+        if (tar->priv_used[pos] == HASH_NONE) {
+            STAT(tar->priv_stats.find_probes += i;)
+            STAT_PROBE(tar, i);
             return ERR;
+        }
 
         // full -> check for equity -> return or continue
-        if (tar->priv_used[pos] == HASH_FULL && EQUAL(&tar->priv_keys[pos], &user_key)) {
+        if (tar->priv_used[pos] == HASH_FULL && EQ(tar, &tar->priv_keys[pos], &user_key)) {
             if (inner_key) *inner_key = &tar->priv_keys[pos];
             if (value)     *value = &tar->priv_values[pos];
+            STAT(tar->priv_stats.find_hits++; tar->priv_stats.find_probes += i;)
+            STAT_PROBE(tar, i);
             return SCC;
         }
     }
 
+    STAT(tar->priv_stats.find_probes += tar->priv_capc;)
+    STAT_PROBE(tar, tar->priv_capc);
     return ERR;
 }
 
@@ -251,11 +349,12 @@ RIFF_API(void) RIFF_INST(hhmap_pop, INSTANCE)(hhmap(INSTANCE)* tar, const KEY* I
     size_t pos = INNER_key - tar->priv_keys;
 
     if (out)  *out = tar->priv_values[pos];
-    else VAL_DEST(&tar->priv_values[pos]);
+    else { VAL_DESTROY(&tar->priv_values[pos]); }
 
-    KEY_DEST(&tar->priv_keys[pos]);
+    KEY_DESTROY(&tar->priv_keys[pos]);
     tar->priv_used[pos] = HASH_TOMB;
     tar->priv_size--;
+    tar->priv_tombs++;
 }
 
 // Clears map
@@ -263,16 +362,49 @@ RIFF_API(void) RIFF_INST(hhmap_pop, INSTANCE)(hhmap(INSTANCE)* tar, const KEY* I
 #define hhmap_clear(inst) RIFF_INST(hhmap_clear, inst)
 
 RIFF_API(void) RIFF_INST(hhmap_clear, INSTANCE)(hhmap(INSTANCE)* tar) {
+#if TRIVIAL
+    if (tar->priv_capc) memset(tar->priv_used, HASH_NONE, tar->priv_capc * sizeof(char));
+#else
     for (size_t i = 0; i < tar->priv_capc; i++) {
         if (tar->priv_used[i] == HASH_FULL) {
-            KEY_DEST(&tar->priv_keys[i]);
-            VAL_DEST(&tar->priv_values[i]);
+            KEY_DESTROY(&tar->priv_keys[i]);
+            VAL_DESTROY(&tar->priv_values[i]);
         }
         tar->priv_used[i] = HASH_NONE; // can do this
     }
-    tar->priv_size = 0;
+#endif
+    tar->priv_size  = 0;
+    tar->priv_tombs = 0;
 }
 
+#ifdef RIFF_STATS
+/*
+    Statistics
+*/
+
+// Returns counters collected since the map was zeroed / destroyed
+// Tombstone ratio is tombstones / capacity, average probe length find_probes / finds
+// Only defined when RIFF_STATS is defined before inclusion
+// O(1)
+#define hhmap_stats(inst) RIFF_INST(hhmap_stats, inst)
+
+RIFF_API(riff_hhmap_stats) RIFF_INST(hhmap_stats, INSTANCE)(const hhmap(INSTANCE)* tar) {
+    riff_hhmap_stats stats = tar->priv_stats;
+    stats.size       = tar->priv_size;
+    stats.tombstones = tar->priv_tombs;
+    stats.capacity   = tar->priv_capc;
+    return stats;
+}
+#endif
+
+#undef STAT
+#undef STAT_PROBE
+#undef EQ
+#undef KEY_DESTROY
+#undef VAL_DESTROY
+
+#undef SLOT_BYTES
+
 #undef INSTANCE
 #undef KEY
 #undef KEY_DEST
@@ -280,6 +412,7 @@ RIFF_API(void) RIFF_INST(hhmap_clear, INSTANCE)(hhmap(INSTANCE)* tar) {
 #undef VAL_DEST
 #undef HASH
 #undef EQUAL
+#undef TRIVIAL
 
 #undef INIT_CAPC
 
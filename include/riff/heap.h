@@ -0,0 +1,450 @@
+/*
+    T macro pattern
+        [instance name], [stored type], [stored type destructor (opt)],
+        [less function - int(func)(const STORED* a, const STORED* b) (non-0 if a goes before b)],
+        [arity (opt) - children per node, 4 by default],
+        [indexed mode (opt) - any identifier, e.g. indexed]
+
+    Top of the heap is the element no other element is less than (min-heap), use "greater" for max-heap
+    Indexed mode gives every element a handle, which stays valid until the element leaves the heap,
+    and allows to access, update (e.g. decrease-key) and remove elements by it
+    In indexed mode elements are pushed by heap_push_indexed() / heap_push_many_indexed(),
+    which give the handles back, heap_push() / heap_push_many() are not defined
+*/
+
+#include "generic.h"
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE   RIFF_FIRST(T)
+#define STORED     RIFF_SECOND(T)
+#define DESTRUCTOR RIFF_THIRD(T)
+#define TRIVIAL    RIFF_IS_EMPTY(DESTRUCTOR)
+#define LESS       RIFF_FOURTH(T)
+#define ARITY      RIFF_OR_DEFAULT(RIFF_FIFTH(T, , ), 4)
+#define INDEXED    (!RIFF_IS_EMPTY(RIFF_SIXTH(T, , )))
+
+#if TRIVIAL
+    #define DESTROY(ptr)
+    #define DESTRUCTOR_LOOP(beg, end)
+#else
+    #define DESTROY(ptr) DESTRUCTOR(ptr)
+    #define DESTRUCTOR_LOOP(beg, end) \
+        for (STORED* ptr = beg; ptr < end; ptr++) DESTRUCTOR(ptr);
+#endif
+
+// moves element from position src to position dst (keeping handles in sync)
+#if INDEXED
+    #define MOVE(tar, dst, src) do {                                       \
+        (tar)->priv_data[dst]    = (tar)->priv_data[src];                  \
+        (tar)->priv_handles[dst] = (tar)->priv_handles[src];               \
+        (tar)->priv_pos[(tar)->priv_handles[dst]] = (dst);                 \
+    } while (0)
+#else
+    #define MOVE(tar, dst, src) ((tar)->priv_data[dst] = (tar)->priv_data[src])
+#endif
+
+/*
+    Typedef
+*/
+
+// d-ary Heap (heap)
+// Priority queue on contiguous storage, arity 4 keeps children of a node within a cache line for small types
+// O(log n) push and pop, O(1) top
+// O(n) memory complexity
+#define heap(inst) RIFF_INST(heap, inst)
+
+typedef struct heap(INSTANCE) {
+    size_t  priv_size;
+    size_t  priv_capc;
+    STORED* priv_data;
+#if INDEXED
+    size_t* priv_handles; // heap position -> handle
+    size_t* priv_pos;     // handle -> heap position, or next free handle + 1 for free ones
+    size_t  priv_free;    // first free handle + 1, 0 if none
+    size_t  priv_next;    // handles never used yet start here
+#endif
+} heap(INSTANCE);
+
+/*
+    Zero / Destruction
+*/
+
+// Makes unitialized memory proper 0-initialized empty heap
+// Does not free anything
+#define heap_zero(inst) RIFF_INST(heap_zero, inst)
+
+RIFF_API(void) heap_zero(INSTANCE)(heap(INSTANCE)* tar) {
+    tar->priv_size = 0;
+    tar->priv_capc = 0;
+    tar->priv_data = NULL;
+#if INDEXED
+    tar->priv_handles = NULL;
+    tar->priv_pos     = NULL;
+    tar->priv_free    = 0;
+    tar->priv_next    = 0;
+#endif
+}
+
+// Properly destroys given heap
+// O(n) if destructor definied, O(1) otherwise
+#define heap_destroy(inst) RIFF_INST(heap_destroy, inst)
+
+RIFF_API(void) heap_destroy(INSTANCE)(heap(INSTANCE)* tar) {
+    DESTRUCTOR_LOOP(tar->priv_data, tar->priv_data + tar->priv_size);
+    RIFF_FREE(tar->priv_data);
+#if INDEXED
+    RIFF_FREE(tar->priv_handles);
+    RIFF_FREE(tar->priv_pos);
+#endif
+    heap_zero(INSTANCE)(tar);
+}
+
+/*
+    Internals
+*/
+
+RIFF_API(void) RIFF_INST(heap_internal_sift_up, INSTANCE)(heap(INSTANCE)* tar, size_t i) {
+    STORED val = tar->priv_data[i];
+#if INDEXED
+    size_t handle = tar->priv_handles[i];
+#endif
+
+    while (i > 0) {
+        size_t parent = (i - 1) / ARITY;
+        if (!LESS(&val, &tar->priv_data[parent])) break;
+        MOVE(tar, i, parent);
+        i = parent;
+    }
+
+    tar->priv_data[i] = val;
+#if INDEXED
+    tar->priv_handles[i]  = handle;
+    tar->priv_pos[handle] = i;
+#endif
+}
+
+RIFF_API(void) RIFF_INST(heap_internal_sift_down, INSTANCE)(heap(INSTANCE)* tar, size_t i) {
+    STORED* data = tar->priv_data;
+    size_t  size = tar->priv_size;
+    STORED  val  = data[i];
+#if INDEXED
+    size_t handle = tar->priv_handles[i];
+#endif
+
+    for (;;) {
+        size_t first = i * ARITY + 1;
+        if (first >= size) break;
+
+        // smallest of the children
+        size_t last = size - first > ARITY ? first + ARITY : size;
+        size_t best = first;
+        for (size_t c = first + 1; c < last; c++) if (LESS(&data[c], &data[best])) best = c;
+
+        if (!LESS(&data[best], &val)) break;
+        MOVE(tar, i, best);
+        i = best;
+    }
+
+    data[i] = val;
+#if INDEXED
+    tar->priv_handles[i]  = handle;
+    tar->priv_pos[handle] = i;
+#endif
+}
+
+#if INDEXED
+RIFF_API(size_t) RIFF_INST(heap_internal_take_handle, INSTANCE)(heap(INSTANCE)* tar) {
+    if (tar->priv_free) {
+        size_t handle  = tar->priv_free - 1;
+        tar->priv_free = tar->priv_pos[handle];
+        return handle;
+    }
+    return tar->priv_next++; // never more handles than capacity
+}
+
+RIFF_API(void) RIFF_INST(heap_internal_release_handle, INSTANCE)(heap(INSTANCE)* tar, size_t handle) {
+    tar->priv_pos[handle] = tar->priv_free;
+    tar->priv_free        = handle + 1;
+}
+#endif
+
+/*
+    Memory
+*/
+
+// Ensures heap have at least given capacity (in total, not left)
+// May fail, O(1) else reallocation time complexity
+#define heap_reserve(inst) RIFF_INST(heap_reserve, inst)
+
+RIFF_API(int) heap_reserve(INSTANCE)(heap(INSTANCE)* tar, size_t capacity) {
+    if (tar->priv_capc >= capacity) return SCC; // already have
+
+    STORED* new_data = (STORED*)RIFF_REALLOC(tar->priv_data, capacity * sizeof(STORED));
+    if (!new_data) return ERR;
+    tar->priv_data = new_data;
+
+#if INDEXED
+    // blocks which succeeded stay bigger than capacity, which is harmless
+    size_t* new_handles = (size_t*)RIFF_REALLOC(tar->priv_handles, capacity * sizeof(size_t));
+    if (!new_handles) return ERR;
+    tar->priv_handles = new_handles;
+
+    size_t* new_pos = (size_t*)RIFF_REALLOC(tar->priv_pos, capacity * sizeof(size_t));
+    if (!new_pos) return ERR;
+    tar->priv_pos = new_pos;
+#endif
+
+    tar->priv_capc = capacity;
+    return SCC;
+}
+
+/*
+    Query
+*/
+
+// Returns count of elements in the heap
+// O(1)
+#define heap_size(inst) RIFF_INST(heap_size, inst)
+
+RIFF_API(size_t) heap_size(INSTANCE)(const heap(INSTANCE)* tar) {
+    return tar->priv_size;
+}
+
+// Returns whether the heap is empty
+// O(1)
+#define heap_empty(inst) RIFF_INST(heap_empty, inst)
+
+RIFF_API(int) heap_empty(INSTANCE)(const heap(INSTANCE)* tar) {
+    return tar->priv_size == 0;
+}
+
+// Returns pointer to the top element, NULL if heap is empty
+// Do not change its priority, use heap_update() in indexed mode for that
+// O(1)
+#define heap_top(inst) RIFF_INST(heap_top, inst)
+
+RIFF_API(STORED*) heap_top(INSTANCE)(heap(INSTANCE)* tar) {
+    return tar->priv_size ? &tar->priv_data[0] : NULL;
+}
+
+/*
+    Operations
+*/
+
+// grows storage if needed and puts value at the end, without restoring heap order
+RIFF_API(int) RIFF_INST(heap_internal_append, INSTANCE)(heap(INSTANCE)* tar, STORED value) {
+    if (tar->priv_size >= tar->priv_capc) {
+        size_t new_cap = tar->priv_capc ? tar->priv_capc * 2 : 4;
+        if (heap_reserve(INSTANCE)(tar, new_cap) == ERR) return ERR;
+    }
+
+    size_t i = tar->priv_size++;
+    tar->priv_data[i] = value;
+#if INDEXED
+    size_t handle = RIFF_INST(heap_internal_take_handle, INSTANCE)(tar);
+    tar->priv_handles[i]  = handle;
+    tar->priv_pos[handle] = i;
+#endif
+    return SCC;
+}
+
+// appends amount elements and restores heap order, in indexed mode sets handles[k] of values[k] (if not NULL)
+RIFF_API(int) RIFF_INST(heap_internal_push_many, INSTANCE)(heap(INSTANCE)* tar, const STORED* values, size_t amount, size_t* handles) {
+    if (heap_reserve(INSTANCE)(tar, tar->priv_size + amount) == ERR) return ERR;
+
+    size_t old_size = tar->priv_size;
+    for (size_t k = 0; k < amount; k++) RIFF_INST(heap_internal_append, INSTANCE)(tar, values[k]); // reserved, cannot fail
+#if INDEXED
+    if (handles) for (size_t k = 0; k < amount; k++) handles[k] = tar->priv_handles[old_size + k];
+#else
+    (void)handles;
+#endif
+
+    if (amount >= old_size) {
+        // Floyd's heapify, from the last parent up
+        if (tar->priv_size > 1)
+            for (size_t i = (tar->priv_size - 2) / ARITY + 1; i-- > 0;) RIFF_INST(heap_internal_sift_down, INSTANCE)(tar, i);
+    }
+    else {
+        for (size_t i = old_size; i < tar->priv_size; i++) RIFF_INST(heap_internal_sift_up, INSTANCE)(tar, i);
+    }
+    return SCC;
+}
+
+#if !INDEXED
+
+// Pushes element into the heap
+// If succeeded heap is now the owner of the object
+// May fail (allocation), O(log n) avg
+#define heap_push(inst) RIFF_INST(heap_push, inst)
+
+RIFF_API(int) heap_push(INSTANCE)(heap(INSTANCE)* tar, STORED value) {
+    if (RIFF_INST(heap_internal_append, INSTANCE)(tar, value) == ERR) return ERR;
+    RIFF_INST(heap_internal_sift_up, INSTANCE)(tar, tar->priv_size - 1);
+    return SCC;
+}
+
+// Pushes amount elements from values array into the heap
+// Rebuilds whole heap bottom-up (O(n)) if it at least doubles, pushes one by one otherwise
+// If succeeded heap is now the owner of the objects
+// May fail (allocation), O(n + amount) or O(amount log n)
+#define heap_push_many(inst) RIFF_INST(heap_push_many, inst)
+
+RIFF_API(int) heap_push_many(INSTANCE)(heap(INSTANCE)* tar, const STORED* values, size_t amount) {
+    return RIFF_INST(heap_internal_push_many, INSTANCE)(tar, values, amount, NULL);
+}
+
+#endif
+
+// Pops out the top element
+// If   out == NULL the element will be destructed
+// Else *out = element and the caller does own the element from now on
+// May fail (empty heap), O(log n)
+#define heap_pop(inst) RIFF_INST(heap_pop, inst)
+
+RIFF_API(int) heap_pop(INSTANCE)(heap(INSTANCE)* tar, STORED* out) {
+    if (tar->priv_size == 0) return ERR;
+
+    if (out) *out = tar->priv_data[0];
+    else     { DESTROY(&tar->priv_data[0]); }
+
+#if INDEXED
+    RIFF_INST(heap_internal_release_handle, INSTANCE)(tar, tar->priv_handles[0]);
+#endif
+
+    // move last element to the root and sink it
+    size_t last = --tar->priv_size;
+    if (last > 0) {
+        MOVE(tar, 0, last);
+        RIFF_INST(heap_internal_sift_down, INSTANCE)(tar, 0);
+    }
+    return SCC;
+}
+
+// Clears heap, destroys contained elements with destructor if provided,
+// but does not reduce its capacity
+// O(1), with destructors O(n)
+#define heap_clear(inst) RIFF_INST(heap_clear, inst)
+
+RIFF_API(void) heap_clear(INSTANCE)(heap(INSTANCE)* tar) {
+    DESTRUCTOR_LOOP(tar->priv_data, tar->priv_data + tar->priv_size);
+    tar->priv_size = 0;
+#if INDEXED
+    tar->priv_free = 0;
+    tar->priv_next = 0;
+#endif
+}
+
+/*
+    Indexed Operations
+*/
+
+#if INDEXED
+
+// Pushes element into the heap, like heap_push()
+// If succeeded and handle is not NULL, sets *handle to the element's handle
+// May fail (allocation), O(log n) avg
+#define heap_push_indexed(inst) RIFF_INST(heap_push_indexed, inst)
+
+RIFF_API(int) heap_push_indexed(INSTANCE)(heap(INSTANCE)* tar, STORED value, size_t* handle) {
+    if (RIFF_INST(heap_internal_append, INSTANCE)(tar, value) == ERR) return ERR;
+
+    size_t i = tar->priv_size - 1;
+    if (handle) *handle = tar->priv_handles[i];
+    RIFF_INST(heap_internal_sift_up, INSTANCE)(tar, i);
+    return SCC;
+}
+
+// Pushes amount elements from values array into the heap, like heap_push_many()
+// If succeeded and handles is not NULL, sets handles[k] to the handle of values[k]
+// May fail (allocation), O(n + amount) or O(amount log n)
+#define heap_push_many_indexed(inst) RIFF_INST(heap_push_many_indexed, inst)
+
+RIFF_API(int) heap_push_many_indexed(INSTANCE)(heap(INSTANCE)* tar, const STORED* values, size_t amount, size_t* handles) {
+    return RIFF_INST(heap_internal_push_many, INSTANCE)(tar, values, amount, handles);
+}
+
+// Returns handle of the top element
+// May fail (empty heap), O(1)
+#define heap_top_handle(inst) RIFF_INST(heap_top_handle, inst)
+
+RIFF_API(int) heap_top_handle(INSTANCE)(const heap(INSTANCE)* tar, size_t* handle) {
+    if (tar->priv_size == 0) return ERR;
+    *handle = tar->priv_handles[0];
+    return SCC;
+}
+
+// Returns pointer to the element with given handle
+// Handle must belong to an element currently in the heap
+// After changing element's priority call heap_update()
+// O(1)
+#define heap_get(inst) RIFF_INST(heap_get, inst)
+
+RIFF_API(STORED*) heap_get(INSTANCE)(heap(INSTANCE)* tar, size_t handle) {
+    return &tar->priv_data[tar->priv_pos[handle]];
+}
+
+// Restores heap order after priority of the element with given handle was changed
+// (both decrease-key and increase-key)
+// Handle must belong to an element currently in the heap
+// O(log n)
+#define heap_update(inst) RIFF_INST(heap_update, inst)
+
+RIFF_API(void) heap_update(INSTANCE)(heap(INSTANCE)* tar, size_t handle) {
+    size_t i = tar->priv_pos[handle];
+    if (i > 0 && LESS(&tar->priv_data[i], &tar->priv_data[(i - 1) / ARITY]))
+         RIFF_INST(heap_internal_sift_up, INSTANCE)(tar, i);
+    else RIFF_INST(heap_internal_sift_down, INSTANCE)(tar, i);
+}
+
+// Removes element with given handle from the heap
+// Handle must belong to an element currently in the heap, it becomes invalid afterwards
+// If   out == NULL the element will be destructed
+// Else *out = element and the caller does own the element from now on
+// O(log n)
+#define heap_remove(inst) RIFF_INST(heap_remove, inst)
+
+RIFF_API(void) heap_remove(INSTANCE)(heap(INSTANCE)* tar, size_t handle, STORED* out) {
+    size_t i = tar->priv_pos[handle];
+
+    if (out) *out = tar->priv_data[i];
+    else     { DESTROY(&tar->priv_data[i]); }
+
+    RIFF_INST(heap_internal_release_handle, INSTANCE)(tar, handle);
+
+    // fill the gap with the last element, which may need to go either way
+    size_t last = --tar->priv_size;
+    if (i != last) {
+        MOVE(tar, i, last);
+        heap_update(INSTANCE)(tar, tar->priv_handles[i]);
+    }
+}
+
+#endif
+
+#undef MOVE
+#undef DESTROY
+#undef DESTRUCTOR_LOOP
+
+#undef INSTANCE
+#undef STORED
+#undef DESTRUCTOR
+#undef TRIVIAL
+#undef LESS
+#undef ARITY
+#undef INDEXED
+
+// consume parameters
+#undef T
+#undef A
@@ -0,0 +1,469 @@
+/*
+    T macro pattern
+        [instance name],
+        [key type],    [key type destructor (opt)],
+        [stored type], [stored type destructor (opt)],
+        [key type hash function - size_t(func)(const KEY*)],
+        [key type equal function - int(func)(const KEY* a, const KEY* b) (non-0 if equal)],
+        [weight function (opt) - size_t(func)(const KEY*, const VAL*), every entry weights 1 by default],
+        [evict callback (opt) - void(func)(KEY*, VAL*), called on entries evicted to make room, before their destruction]
+
+    Bounded cache, least recently used entries are evicted once the total weight exceeds the capacity
+    Capacity is 0 for zero-initialized cache, set it with lru_set_capacity() before use
+    Entries live in one open addressing table (linear probing, backward shift deletion, no tombstones),
+    recency list links are slot indices stored in the entries, so there is no allocation per entry
+    Low bits of the hash pick the slot
+*/
+
+#include "generic.h"
+
+#include <stdint.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE RIFF_FIRST(T)
+#define KEY      RIFF_SECOND(T)
+#define KEY_DEST RIFF_THIRD(T)
+#define VAL      RIFF_FOURTH(T)
+#define VAL_DEST RIFF_FIFTH(T)
+#define HASH     RIFF_SIXTH(T)
+#define EQUAL    RIFF_SEVENTH(T)
+#define WEIGHT   RIFF_EIGHTH(T, , )
+#define EVICT    RIFF_NINTH(T, , )
+#define WEIGHTED (!RIFF_IS_EMPTY(WEIGHT))
+
+#if RIFF_IS_EMPTY(KEY_DEST)
+    #define KEY_DESTROY(ptr)
+#else
+    #define KEY_DESTROY(ptr) KEY_DEST(ptr)
+#endif
+
+#if RIFF_IS_EMPTY(VAL_DEST)
+    #define VAL_DESTROY(ptr)
+#else
+    #define VAL_DESTROY(ptr) VAL_DEST(ptr)
+#endif
+
+#if RIFF_IS_EMPTY(EVICT)
+    #define ON_EVICT(key, val)
+#else
+    #define ON_EVICT(key, val) EVICT(key, val);
+#endif
+
+#if WEIGHTED
+    #define WEIGHT_OF(key, val) WEIGHT(key, val)
+    #define ENTRY_WEIGHT(e)     ((e)->priv_weight)
+#else
+    #define WEIGHT_OF(key, val) ((size_t)1)
+    #define ENTRY_WEIGHT(e)     ((size_t)1)
+#endif
+
+#define NONE      ((size_t)(-1))
+#define INIT_SLOTS 16
+
+/*
+    Typedef
+*/
+
+// LRU cache entry, table slot and recency list node at once
+// Links are slot + 1, 0 for none
+#define lru_entry(inst) RIFF_INST(lru_entry, inst)
+
+typedef struct lru_entry(INSTANCE) {
+    KEY           priv_key;
+    VAL           priv_value;
+#if WEIGHTED
+    size_t        priv_weight;
+#endif
+    uint32_t      priv_hash; // low 32 bits of the key hash
+    uint32_t      priv_prev; // more recently used entry
+    uint32_t      priv_next; // less recently used entry
+    unsigned char priv_used;
+} lru_entry(INSTANCE);
+
+// LRU cache (lru)
+// Hash map of bounded total weight, which evicts least recently used entries
+// O(1) avg get, put and evict, at most 3/4 of the slots are used
+// O(n) memory complexity
+#define lru(inst) RIFF_INST(lru, inst)
+
+typedef struct lru(INSTANCE) {
+    lru_entry(INSTANCE)* priv_table;
+    size_t   priv_slots;    // size of table, power of two or 0
+    size_t   priv_size;     // count of entries
+    size_t   priv_weight;   // total weight of entries
+    size_t   priv_capacity; // limit of total weight
+    uint32_t priv_head;     // most recently used slot + 1, 0 if empty
+    uint32_t priv_tail;     // least recently used slot + 1, 0 if empty
+} lru(INSTANCE);
+
+/*
+    Zero / Destruction
+*/
+
+// Makes unitialized memory proper 0-initialized empty cache of capacity 0
+// Does not free anything
+#define lru_zero(inst) RIFF_INST(lru_zero, inst)
+
+RIFF_API(void) lru_zero(INSTANCE)(lru(INSTANCE)* tar) {
+    tar->priv_table    = NULL;
+    tar->priv_slots    = 0;
+    tar->priv_size     = 0;
+    tar->priv_weight   = 0;
+    tar->priv_capacity = 0;
+    tar->priv_head     = 0;
+    tar->priv_tail     = 0;
+}
+
+// Destroys keys and values (evict callback is not called) and frees memory
+// Capacity is reset to 0
+// O(n)
+#define lru_destroy(inst) RIFF_INST(lru_destroy, inst)
+
+RIFF_API(void) lru_destroy(INSTANCE)(lru(INSTANCE)* tar) {
+#if !RIFF_IS_EMPTY(KEY_DEST) || !RIFF_IS_EMPTY(VAL_DEST)
+    for (uint32_t k = tar->priv_head; k; k = tar->priv_table[k - 1].priv_next) {
+        KEY_DESTROY(&tar->priv_table[k - 1].priv_key);
+        VAL_DESTROY(&tar->priv_table[k - 1].priv_value);
+    }
+#endif
+    RIFF_FREE(tar->priv_table);
+    lru_zero(INSTANCE)(tar);
+}
+
+/*
+    Internals
+*/
+
+// detaches slot i from the recency list
+RIFF_API(void) RIFF_INST(lru_internal_unlink, INSTANCE)(lru(INSTANCE)* tar, size_t i) {
+    lru_entry(INSTANCE)* e = &tar->priv_table[i];
+    if (e->priv_prev) tar->priv_table[e->priv_prev - 1].priv_next = e->priv_next;
+    else              tar->priv_head = e->priv_next;
+    if (e->priv_next) tar->priv_table[e->priv_next - 1].priv_prev = e->priv_prev;
+    else              tar->priv_tail = e->priv_prev;
+}
+
+// attaches slot i at the front (most recently used) of the recency list
+RIFF_API(void) RIFF_INST(lru_internal_link_front, INSTANCE)(lru(INSTANCE)* tar, size_t i) {
+    lru_entry(INSTANCE)* e = &tar->priv_table[i];
+    e->priv_prev = 0;
+    e->priv_next = tar->priv_head;
+    if (tar->priv_head) tar->priv_table[tar->priv_head - 1].priv_prev = (uint32_t)(i + 1);
+    else                tar->priv_tail = (uint32_t)(i + 1);
+    tar->priv_head = (uint32_t)(i + 1);
+}
+
+// neighbours of the entry moved into slot i point to it again
+RIFF_API(void) RIFF_INST(lru_internal_relink, INSTANCE)(lru(INSTANCE)* tar, size_t i) {
+    lru_entry(INSTANCE)* e = &tar->priv_table[i];
+    if (e->priv_prev) tar->priv_table[e->priv_prev - 1].priv_next = (uint32_t)(i + 1);
+    else              tar->priv_head = (uint32_t)(i + 1);
+    if (e->priv_next) tar->priv_table[e->priv_next - 1].priv_prev = (uint32_t)(i + 1);
+    else              tar->priv_tail = (uint32_t)(i + 1);
+}
+
+// slot of the key, NONE if not present
+RIFF_API(size_t) RIFF_INST(lru_internal_find, INSTANCE)(const lru(INSTANCE)* tar, const KEY* key, uint32_t hash) {
+    if (tar->priv_size == 0) return NONE;
+
+    size_t mask = tar->priv_slots - 1;
+    for (size_t i = hash & mask; tar->priv_table[i].priv_used; i = (i + 1) & mask) {
+        const lru_entry(INSTANCE)* e = &tar->priv_table[i];
+        if (e->priv_hash == hash && EQUAL(&e->priv_key, key)) return i;
+    }
+    return NONE;
+}
+
+// empties slot i (already unlinked, key and value already taken care of),
+// following entries of the probe run move back so no tombstone is needed
+RIFF_API(void) RIFF_INST(lru_internal_remove, INSTANCE)(lru(INSTANCE)* tar, size_t i) {
+    size_t mask = tar->priv_slots - 1;
+
+    for (size_t j = (i + 1) & mask; tar->priv_table[j].priv_used; j = (j + 1) & mask) {
+        size_t home = tar->priv_table[j].priv_hash & mask;
+        if (((j - home) & mask) < ((j - i) & mask)) continue; // its home is after the hole, stays
+
+        tar->priv_table[i] = tar->priv_table[j];
+        RIFF_INST(lru_internal_relink, INSTANCE)(tar, i);
+        i = j;
+    }
+    tar->priv_table[i].priv_used = 0;
+}
+
+// evicts the least recently used entry through the evict callback
+RIFF_API(void) RIFF_INST(lru_internal_evict, INSTANCE)(lru(INSTANCE)* tar) {
+    size_t               i = tar->priv_tail - 1;
+    lru_entry(INSTANCE)* e = &tar->priv_table[i];
+    (void)e; // unused for trivial, unweighted instance without callback
+
+    RIFF_INST(lru_internal_unlink, INSTANCE)(tar, i);
+    tar->priv_weight -= ENTRY_WEIGHT(e);
+    tar->priv_size--;
+
+    ON_EVICT(&e->priv_key, &e->priv_value)
+    KEY_DESTROY(&e->priv_key);
+    VAL_DESTROY(&e->priv_value);
+    RIFF_INST(lru_internal_remove, INSTANCE)(tar, i);
+}
+
+// moves entries into a new table of given slot count, keeping the recency order
+RIFF_API(int) RIFF_INST(lru_internal_grow, INSTANCE)(lru(INSTANCE)* tar, size_t slots) {
+    if (slots > (size_t)UINT32_MAX) return ERR; // links are 32 bit
+
+    lru_entry(INSTANCE)* table = (lru_entry(INSTANCE)*)RIFF_ALLOC(slots * sizeof(lru_entry(INSTANCE)));
+    if (!table) return ERR;
+    for (size_t i = 0; i < slots; i++) table[i].priv_used = 0;
+
+    lru_entry(INSTANCE)* old  = tar->priv_table;
+    uint32_t             tail = tar->priv_tail;
+    size_t               mask = slots - 1;
+
+    tar->priv_table = table;
+    tar->priv_slots = slots;
+    tar->priv_head  = 0;
+    tar->priv_tail  = 0;
+
+    // least recently used first, each pushed at the front
+    for (uint32_t k = tail; k; k = old[k - 1].priv_prev) {
+        size_t j = old[k - 1].priv_hash & mask;
+        while (table[j].priv_used) j = (j + 1) & mask;
+
+        table[j] = old[k - 1];
+        RIFF_INST(lru_internal_link_front, INSTANCE)(tar, j);
+    }
+
+    RIFF_FREE(old);
+    return SCC;
+}
+
+/*
+    Capacity / Query
+*/
+
+// Sets limit of total weight, evicts least recently used entries until they fit
+// O(1) else O(evicted)
+#define lru_set_capacity(inst) RIFF_INST(lru_set_capacity, inst)
+
+RIFF_API(void) lru_set_capacity(INSTANCE)(lru(INSTANCE)* tar, size_t capacity) {
+    tar->priv_capacity = capacity;
+    while (tar->priv_weight > tar->priv_capacity) RIFF_INST(lru_internal_evict, INSTANCE)(tar);
+}
+
+// Returns limit of total weight
+// O(1)
+#define lru_capacity(inst) RIFF_INST(lru_capacity, inst)
+
+RIFF_API(size_t) lru_capacity(INSTANCE)(const lru(INSTANCE)* tar) {
+    return tar->priv_capacity;
+}
+
+// Returns count of entries
+// O(1)
+#define lru_size(inst) RIFF_INST(lru_size, inst)
+
+RIFF_API(size_t) lru_size(INSTANCE)(const lru(INSTANCE)* tar) {
+    return tar->priv_size;
+}
+
+// Returns total weight of entries (same as size without weight function)
+// O(1)
+#define lru_weight(inst) RIFF_INST(lru_weight, inst)
+
+RIFF_API(size_t) lru_weight(INSTANCE)(const lru(INSTANCE)* tar) {
+    return tar->priv_weight;
+}
+
+/*
+    Operations
+*/
+
+// Inserts new entry or replaces the entry of given key, which becomes most recently used
+// Least recently used entries are evicted (evict callback) to keep total weight within capacity
+// Given key and value are owned by the cache on success
+// May fail (weight above capacity, allocation failure), O(1) avg
+#define lru_put(inst) RIFF_INST(lru_put, inst)
+
+RIFF_API(int) lru_put(INSTANCE)(lru(INSTANCE)* tar, KEY key, VAL value) {
+    size_t   weight = WEIGHT_OF(&key, &value);
+    uint32_t hash   = (uint32_t)HASH(&key);
+    if (weight > tar->priv_capacity) return ERR; // could never fit
+
+    size_t i = RIFF_INST(lru_internal_find, INSTANCE)(tar, &key, hash);
+
+    // replace, like hhmap_push destroys old key and value
+    if (i != NONE) {
+        lru_entry(INSTANCE)* e = &tar->priv_table[i];
+        KEY_DESTROY(&e->priv_key);
+        VAL_DESTROY(&e->priv_value);
+        e->priv_key   = key;
+        e->priv_value = value;
+        tar->priv_weight = tar->priv_weight - ENTRY_WEIGHT(e) + weight;
+#if WEIGHTED
+        e->priv_weight = weight;
+#endif
+        RIFF_INST(lru_internal_unlink, INSTANCE)(tar, i);
+        RIFF_INST(lru_internal_link_front, INSTANCE)(tar, i);
+
+        // the entry is the head, evictions stop before it as its weight fits
+        while (tar->priv_weight > tar->priv_capacity) RIFF_INST(lru_internal_evict, INSTANCE)(tar);
+        return SCC;
+    }
+
+    // grow before evicting anything, so failure leaves the cache unchanged
+    if ((tar->priv_size + 1) * 4 > tar->priv_slots * 3) {
+        size_t slots = tar->priv_slots ? tar->priv_slots * 2 : INIT_SLOTS;
+        if (RIFF_INST(lru_internal_grow, INSTANCE)(tar, slots) == ERR) return ERR;
+    }
+
+    while (tar->priv_weight + weight > tar->priv_capacity) RIFF_INST(lru_internal_evict, INSTANCE)(tar);
+
+    size_t mask = tar->priv_slots - 1;
+    i = hash & mask;
+    while (tar->priv_table[i].priv_used) i = (i + 1) & mask;
+
+    lru_entry(INSTANCE)* e = &tar->priv_table[i];
+    e->priv_key   = key;
+    e->priv_value = value;
+    e->priv_hash  = hash;
+    e->priv_used  = 1;
+#if WEIGHTED
+    e->priv_weight = weight;
+#endif
+    RIFF_INST(lru_internal_link_front, INSTANCE)(tar, i);
+
+    tar->priv_size++;
+    tar->priv_weight += weight;
+    return SCC;
+}
+
+// Returns pointer to the value of given key and marks the entry most recently used, NULL if not present
+// Pointer is invalidated by puts and removals
+// O(1) avg
+#define lru_get(inst) RIFF_INST(lru_get, inst)
+
+RIFF_API(VAL*) lru_get(INSTANCE)(lru(INSTANCE)* tar, KEY key) {
+    size_t i = RIFF_INST(lru_internal_find, INSTANCE)(tar, &key, (uint32_t)HASH(&key));
+    if (i == NONE) return NULL;
+
+    if (tar->priv_head != i + 1) {
+        RIFF_INST(lru_internal_unlink, INSTANCE)(tar, i);
+        RIFF_INST(lru_internal_link_front, INSTANCE)(tar, i);
+    }
+    return &tar->priv_table[i].priv_value;
+}
+
+// Returns pointer to the value of given key without changing recency, NULL if not present
+// Pointer is invalidated by puts and removals
+// O(1) avg
+#define lru_peek(inst) RIFF_INST(lru_peek, inst)
+
+RIFF_API(VAL*) lru_peek(INSTANCE)(lru(INSTANCE)* tar, KEY key) {
+    size_t i = RIFF_INST(lru_internal_find, INSTANCE)(tar, &key, (uint32_t)HASH(&key));
+    return i == NONE ? NULL : &tar->priv_table[i].priv_value;
+}
+
+// Marks the entry of given key most recently used
+// May fail (no such key), O(1) avg
+#define lru_touch(inst) RIFF_INST(lru_touch, inst)
+
+RIFF_API(int) lru_touch(INSTANCE)(lru(INSTANCE)* tar, KEY key) {
+    return lru_get(INSTANCE)(tar, key) ? SCC : ERR;
+}
+
+// Removes the entry of given key, evict callback is not called
+// If out is NULL stored value will be destructed (if destructor provided)
+// otherwise it will be moved into *out, the stored key is destructed
+// May fail (no such key), O(1) avg
+#define lru_pop(inst) RIFF_INST(lru_pop, inst)
+
+RIFF_API(int) lru_pop(INSTANCE)(lru(INSTANCE)* tar, KEY key, VAL* out) {
+    size_t i = RIFF_INST(lru_internal_find, INSTANCE)(tar, &key, (uint32_t)HASH(&key));
+    if (i == NONE) return ERR;
+
+    lru_entry(INSTANCE)* e = &tar->priv_table[i];
+    RIFF_INST(lru_internal_unlink, INSTANCE)(tar, i);
+    tar->priv_weight -= ENTRY_WEIGHT(e);
+    tar->priv_size--;
+
+    if (out) *out = e->priv_value;
+    else     { VAL_DESTROY(&e->priv_value); }
+    KEY_DESTROY(&e->priv_key);
+
+    RIFF_INST(lru_internal_remove, INSTANCE)(tar, i);
+    return SCC;
+}
+
+// Sets *key and *value (each may be NULL) to the least recently used entry, the next one to be evicted
+// Changes to the key are forbidden, pointers are invalidated by puts and removals
+// May fail (empty cache), O(1)
+#define lru_oldest(inst) RIFF_INST(lru_oldest, inst)
+
+RIFF_API(int) lru_oldest(INSTANCE)(lru(INSTANCE)* tar, const KEY** key, VAL** value) {
+    if (!tar->priv_tail) return ERR;
+    lru_entry(INSTANCE)* e = &tar->priv_table[tar->priv_tail - 1];
+    if (key)   *key   = &e->priv_key;
+    if (value) *value = &e->priv_value;
+    return SCC;
+}
+
+// Evicts the least recently used entry, through the evict callback if provided
+// May fail (empty cache), O(1) avg
+#define lru_evict(inst) RIFF_INST(lru_evict, inst)
+
+RIFF_API(int) lru_evict(INSTANCE)(lru(INSTANCE)* tar) {
+    if (!tar->priv_tail) return ERR;
+    RIFF_INST(lru_internal_evict, INSTANCE)(tar);
+    return SCC;
+}
+
+// Removes all entries (evict callback is not called), keeps table and capacity
+// O(n)
+#define lru_clear(inst) RIFF_INST(lru_clear, inst)
+
+RIFF_API(void) lru_clear(INSTANCE)(lru(INSTANCE)* tar) {
+    for (uint32_t k = tar->priv_head; k; k = tar->priv_table[k - 1].priv_next) {
+        lru_entry(INSTANCE)* e = &tar->priv_table[k - 1];
+        KEY_DESTROY(&e->priv_key);
+        VAL_DESTROY(&e->priv_value);
+        e->priv_used = 0;
+    }
+    tar->priv_size   = 0;
+    tar->priv_weight = 0;
+    tar->priv_head   = 0;
+    tar->priv_tail   = 0;
+}
+
+#undef KEY_DESTROY
+#undef VAL_DESTROY
+#undef ON_EVICT
+#undef WEIGHT_OF
+#undef ENTRY_WEIGHT
+
+#undef NONE
+#undef INIT_SLOTS
+
+#undef INSTANCE
+#undef KEY
+#undef KEY_DEST
+#undef VAL
+#undef VAL_DEST
+#undef HASH
+#undef EQUAL
+#undef WEIGHT
+#undef EVICT
+#undef WEIGHTED
+
+// consume parameters
+#undef T
+#undef A
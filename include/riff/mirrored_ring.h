@@ -0,0 +1,305 @@
+/*
+    T macro pattern
+        [instance name], [stored type]
+
+    Ring buffer queue whose storage is mapped twice back to back, so any range of elements,
+    also one wrapping around the capacity, is contiguous in memory
+    Producers write in place (mring_reserve_write() / mring_commit_write()),
+    consumers read in place (mring_peek_read() / mring_consume_read()), nothing is split or copied
+
+    Linux only (memfd_create, mmap), in C define _GNU_SOURCE before the first include of any header
+    "A" macro is optional and ignored (but consumed) - the buffer is made of mapped pages, the allocator is never called
+    Stored type must be trivial, consumed elements are dropped without destruction
+    Capacity is rounded up so the buffer is a whole count of pages and elements
+*/
+
+#include "generic.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#if !defined(__linux__)
+    #error mirrored_ring.h requires Linux (memfd_create).
+#endif
+
+/*
+    Mapping
+*/
+
+#ifndef RIFF_MRING_MAPPING
+#define RIFF_MRING_MAPPING
+
+// Maps bytes (a multiple of the page size) of an anonymous file twice, back to back
+// Returns start of the first mapping, NULL on failure
+// O(1) syscalls
+RIFF_API(void*) riff_mring_map(size_t bytes) {
+    if (bytes == 0 || bytes > SIZE_MAX / 2) return NULL;
+
+    int fd = memfd_create("riff_mring", MFD_CLOEXEC);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, (off_t)bytes) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // reserve address space for both halves, then put the file over each of them
+    uint8_t* base = (uint8_t*)mmap(NULL, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == (uint8_t*)MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    if (mmap(base,         bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(base + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, 2 * bytes);
+        close(fd);
+        return NULL;
+    }
+
+    // mappings keep the file alive
+    close(fd);
+    return base;
+}
+
+// Unmaps memory of riff_mring_map(bytes)
+// O(1) syscalls
+RIFF_API(void) riff_mring_unmap(void* base, size_t bytes) {
+    if (base) munmap(base, 2 * bytes);
+}
+
+// Returns bytes of the smallest buffer holding at least count elements of given size,
+// being a multiple of both the page size and the element size, 0 on overflow
+// O(element size)
+RIFF_API(size_t) riff_mring_bytes(size_t count, size_t elem) {
+    long   sys  = sysconf(_SC_PAGESIZE);
+    size_t page = sys > 0 ? (size_t)sys : 4096;
+    if (count > (SIZE_MAX / 2 - page) / elem) return 0;
+
+    size_t bytes = (count * elem + page - 1) / page * page;
+    while (bytes % elem) {
+        if (bytes > SIZE_MAX / 2 - page) return 0;
+        bytes += page;
+    }
+    return bytes;
+}
+
+#endif // RIFF_MRING_MAPPING
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE RIFF_FIRST(T)
+#define STORED   RIFF_SECOND(T)
+
+/*
+    Typedef
+*/
+
+// Mirrored ring buffer (mring)
+// Fixed capacity circular buffer, elements [read, read + size) are always contiguous
+// O(1) reserve / commit / peek / consume
+// O(capacity) memory complexity (twice that of address space)
+#define mring(inst) RIFF_INST(mring, inst)
+
+typedef struct mring(INSTANCE) {
+    STORED* priv_data; // 2 * capc elements, the second half mirrors the first one
+    size_t  priv_capc;
+    size_t  priv_read; // position of the first element, in [0, capc)
+    size_t  priv_size;
+} mring(INSTANCE);
+
+/*
+    Zero / Destruction
+*/
+
+// Makes unitialized memory proper 0-initialized ring of capacity 0
+// Does not free anything
+#define mring_zero(inst) RIFF_INST(mring_zero, inst)
+
+RIFF_API(void) mring_zero(INSTANCE)(mring(INSTANCE)* tar) {
+    tar->priv_data = NULL;
+    tar->priv_capc = 0;
+    tar->priv_read = 0;
+    tar->priv_size = 0;
+}
+
+// Unmaps the buffer, unconsumed elements are dropped
+// O(1)
+#define mring_destroy(inst) RIFF_INST(mring_destroy, inst)
+
+RIFF_API(void) mring_destroy(INSTANCE)(mring(INSTANCE)* tar) {
+    riff_mring_unmap(tar->priv_data, tar->priv_capc * sizeof(STORED));
+    mring_zero(INSTANCE)(tar);
+}
+
+/*
+    Memory
+*/
+
+// Ensures ring have at least given capacity (in total, not left)
+// Unconsumed elements are kept, spans taken before are invalidated
+// May fail (mapping failure), O(1) else O(n) copy
+#define mring_reserve(inst) RIFF_INST(mring_reserve, inst)
+
+RIFF_API(int) mring_reserve(INSTANCE)(mring(INSTANCE)* tar, size_t capacity) {
+    if (tar->priv_capc >= capacity) return SCC; // already have
+
+    size_t  bytes    = riff_mring_bytes(capacity, sizeof(STORED));
+    STORED* new_data = bytes ? (STORED*)riff_mring_map(bytes) : NULL;
+    if (!new_data) return ERR;
+
+    // elements are contiguous in the old mapping, so one copy
+    if (tar->priv_size) memcpy(new_data, tar->priv_data + tar->priv_read, tar->priv_size * sizeof(STORED));
+    riff_mring_unmap(tar->priv_data, tar->priv_capc * sizeof(STORED));
+
+    tar->priv_data = new_data;
+    tar->priv_capc = bytes / sizeof(STORED);
+    tar->priv_read = 0;
+    return SCC;
+}
+
+/*
+    Query
+*/
+
+// Returns count of readable elements
+// O(1)
+#define mring_size(inst) RIFF_INST(mring_size, inst)
+
+RIFF_API(size_t) mring_size(INSTANCE)(const mring(INSTANCE)* tar) {
+    return tar->priv_size;
+}
+
+// Returns count of elements the ring can hold
+// O(1)
+#define mring_capacity(inst) RIFF_INST(mring_capacity, inst)
+
+RIFF_API(size_t) mring_capacity(INSTANCE)(const mring(INSTANCE)* tar) {
+    return tar->priv_capc;
+}
+
+// Returns count of elements which can be written (capacity - size)
+// O(1)
+#define mring_space(inst) RIFF_INST(mring_space, inst)
+
+RIFF_API(size_t) mring_space(INSTANCE)(const mring(INSTANCE)* tar) {
+    return tar->priv_capc - tar->priv_size;
+}
+
+/*
+    Spans
+*/
+
+// Returns pointer to count contiguous slots after the last element, for the producer to fill
+// Slots become readable by mring_commit_write(), reserving again before it returns the same slots
+// Returns NULL if fewer than count slots are free (see mring_space())
+// O(1)
+#define mring_reserve_write(inst) RIFF_INST(mring_reserve_write, inst)
+
+RIFF_API(STORED*) mring_reserve_write(INSTANCE)(mring(INSTANCE)* tar, size_t count) {
+    if (!tar->priv_data || count > tar->priv_capc - tar->priv_size) return NULL;
+    return tar->priv_data + tar->priv_read + tar->priv_size;
+}
+
+// Makes count slots after the last element readable, filled through mring_reserve_write()
+// May fail (count above mring_space()), O(1)
+#define mring_commit_write(inst) RIFF_INST(mring_commit_write, inst)
+
+RIFF_API(int) mring_commit_write(INSTANCE)(mring(INSTANCE)* tar, size_t count) {
+    if (count > tar->priv_capc - tar->priv_size) return ERR;
+    tar->priv_size += count;
+    return SCC;
+}
+
+// Returns pointer to the first element, all mring_size() elements after it are contiguous
+// Writes the size into *count (if not NULL), returns NULL if empty
+// O(1)
+#define mring_peek_read(inst) RIFF_INST(mring_peek_read, inst)
+
+RIFF_API(STORED*) mring_peek_read(INSTANCE)(mring(INSTANCE)* tar, size_t* count) {
+    if (count) *count = tar->priv_size;
+    if (tar->priv_size == 0) return NULL;
+    return tar->priv_data + tar->priv_read;
+}
+
+// Drops count elements from the front, pointers from mring_peek_read() to them become invalid
+// May fail (count above mring_size()), O(1)
+#define mring_consume_read(inst) RIFF_INST(mring_consume_read, inst)
+
+RIFF_API(int) mring_consume_read(INSTANCE)(mring(INSTANCE)* tar, size_t count) {
+    if (count > tar->priv_size) return ERR;
+    tar->priv_size -= count;
+    tar->priv_read += count;
+    if (tar->priv_read >= tar->priv_capc) tar->priv_read -= tar->priv_capc;
+    return SCC;
+}
+
+/*
+    Operations
+*/
+
+// Copies count elements from src to the end
+// May fail (not enough space), O(count)
+#define mring_write(inst) RIFF_INST(mring_write, inst)
+
+RIFF_API(int) mring_write(INSTANCE)(mring(INSTANCE)* tar, const STORED* src, size_t count) {
+    STORED* span = mring_reserve_write(INSTANCE)(tar, count);
+    if (!span) return ERR;
+    if (count) memcpy(span, src, count * sizeof(STORED));
+    tar->priv_size += count;
+    return SCC;
+}
+
+// Copies count elements from the front into dst and consumes them
+// May fail (fewer elements), O(count)
+#define mring_read(inst) RIFF_INST(mring_read, inst)
+
+RIFF_API(int) mring_read(INSTANCE)(mring(INSTANCE)* tar, STORED* dst, size_t count) {
+    if (count > tar->priv_size) return ERR;
+    if (count) memcpy(dst, tar->priv_data + tar->priv_read, count * sizeof(STORED));
+    return mring_consume_read(INSTANCE)(tar, count);
+}
+
+// Pushes element at the end
+// May fail (ring full), O(1)
+#define mring_push(inst) RIFF_INST(mring_push, inst)
+
+RIFF_API(int) mring_push(INSTANCE)(mring(INSTANCE)* tar, STORED value) {
+    STORED* span = mring_reserve_write(INSTANCE)(tar, 1);
+    if (!span) return ERR;
+    *span = value;
+    tar->priv_size++;
+    return SCC;
+}
+
+// Pops the front element into *out (if not NULL)
+// May fail (empty ring), O(1)
+#define mring_pop(inst) RIFF_INST(mring_pop, inst)
+
+RIFF_API(int) mring_pop(INSTANCE)(mring(INSTANCE)* tar, STORED* out) {
+    if (tar->priv_size == 0) return ERR;
+    if (out) *out = tar->priv_data[tar->priv_read];
+    return mring_consume_read(INSTANCE)(tar, 1);
+}
+
+// Drops all elements, keeps the mapping
+// O(1)
+#define mring_clear(inst) RIFF_INST(mring_clear, inst)
+
+RIFF_API(void) mring_clear(INSTANCE)(mring(INSTANCE)* tar) {
+    tar->priv_read = 0;
+    tar->priv_size = 0;
+}
+
+#undef INSTANCE
+#undef STORED
+
+// consume parameters
+#undef T
+#undef A
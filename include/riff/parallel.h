@@ -0,0 +1,415 @@
+/*
+    T macro pattern
+        [instance name], [stored type],
+        [less function - int(func)(const STORED* a, const STORED* b) (non-0 if a < b)],
+        [combine function (opt) - void(func)(STORED* acc, const STORED* val) (*acc = *acc op *val, op associative)]
+
+    Multi-threaded (pthreads) versions of algorithms over plain buffers, e.g. dyarr_access() ones
+    Requires algorithms.h (with the same less function) and dynamic_array.h to be included
+    with the same instance name beforehand
+    par_prefix_sum() and par_reduce() are only defined when the combine function is provided
+
+    Every function takes requested count of threads (0 means all online cores)
+    Work is split into contiguous chunks, one per thread, calling thread processes the first one
+    Inputs too small to give each thread RIFF_PAR_CUTOFF elements use fewer threads, down to serial code
+    If a thread cannot be created its chunk is processed by the calling thread, so threading never fails
+*/
+
+#include "generic.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Thread Runner
+*/
+
+#ifndef RIFF_PARALLEL_RUNNER
+#define RIFF_PARALLEL_RUNNER
+
+// minimal amount of elements per thread, can be defined before first inclusion
+#ifndef RIFF_PAR_CUTOFF
+    #define RIFF_PAR_CUTOFF 16384
+#endif
+
+// upper bound for threads used by a single call
+#define RIFF_PAR_MAX_THREADS 128
+
+// Returns count of threads to use for size elements
+// 0 requested means all online cores, result is within [1, RIFF_PAR_MAX_THREADS]
+// O(1)
+RIFF_API(size_t) riff_par_threads(size_t requested, size_t size) {
+    if (requested == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        requested = cores > 0 ? (size_t)cores : 1;
+    }
+
+    size_t most = size / RIFF_PAR_CUTOFF;
+    if (requested > most)                 requested = most;
+    if (requested > RIFF_PAR_MAX_THREADS) requested = RIFF_PAR_MAX_THREADS;
+    return requested ? requested : 1;
+}
+
+// Runs job on each of count argument blocks, args points to count blocks of arg_size bytes
+// Calling thread runs the first job, jobs whose thread failed to start run on it afterwards
+// Returns after all jobs are done
+RIFF_API(void) riff_par_run(void* (*job)(void*), void* args, size_t arg_size, size_t count) {
+    pthread_t threads[RIFF_PAR_MAX_THREADS];
+    char      started[RIFF_PAR_MAX_THREADS];
+
+    for (size_t i = 1; i < count; i++)
+        started[i] = pthread_create(&threads[i], NULL, job, (char*)args + i * arg_size) == 0;
+
+    job(args);
+
+    for (size_t i = 1; i < count; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+        else            job((char*)args + i * arg_size);
+    }
+}
+
+#endif // RIFF_PARALLEL_RUNNER
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE RIFF_FIRST(T)
+#define STORED   RIFF_SECOND(T)
+#define LESS     RIFF_THIRD(T)
+#define COMBINE  RIFF_FOURTH(T, , )
+
+// i-th of count chunks of size elements: [CHUNK_BEGIN(i), CHUNK_BEGIN(i + 1))
+#define CHUNK_BEGIN(i, count, size) ((size) / (count) * (i) + ((i) < (size) % (count) ? (i) : (size) % (count)))
+
+/*
+    Internals
+*/
+
+// describes a part of work of a single thread
+typedef struct RIFF_INST(par_internal_job, INSTANCE) {
+    STORED*       data;
+    size_t        size;
+    const STORED* other;      // second merge input
+    size_t        other_size;
+    STORED*       out;
+    STORED        acc;        // reduction result / prefix offset
+    size_t        count;      // filter matches
+    int           has_acc;
+    void        (*map)(STORED*, void*);
+    int         (*pred)(const STORED*, void*);
+    void*         ctx;
+} RIFF_INST(par_internal_job, INSTANCE);
+
+#define JOB RIFF_INST(par_internal_job, INSTANCE)
+
+RIFF_API(void*) RIFF_INST(par_internal_sort_job, INSTANCE)(void* arg) {
+    JOB* job = (JOB*)arg;
+    algo_sort(INSTANCE)(job->data, job->size);
+    return NULL;
+}
+
+RIFF_API(void*) RIFF_INST(par_internal_merge_job, INSTANCE)(void* arg) {
+    JOB* job = (JOB*)arg;
+    algo_merge(INSTANCE)(job->data, job->size, job->other, job->other_size, job->out);
+    return NULL;
+}
+
+// amount of elements taken from a, when first k elements of stable merge of a and b are taken
+// O(log n)
+RIFF_API(size_t) RIFF_INST(par_internal_co_rank, INSTANCE)(
+    size_t k, const STORED* a, size_t size_a, const STORED* b, size_t size_b
+) {
+    size_t lo = k > size_b ? k - size_b : 0;
+    size_t hi = k < size_a ? k : size_a;
+
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        size_t j = k - i;
+
+        // a[i] goes before b[j - 1] (ties prefer a) -> take more from a
+        if (j > 0 && !LESS(&b[j - 1], &a[i])) lo = i + 1;
+        else                                 hi = i;
+    }
+    return lo;
+}
+
+RIFF_API(void*) RIFF_INST(par_internal_map_job, INSTANCE)(void* arg) {
+    JOB* job = (JOB*)arg;
+    for (size_t i = 0; i < job->size; i++) job->map(&job->data[i], job->ctx);
+    return NULL;
+}
+
+RIFF_API(void*) RIFF_INST(par_internal_filter_job, INSTANCE)(void* arg) {
+    JOB* job = (JOB*)arg;
+    size_t count = 0;
+    for (size_t i = 0; i < job->size; i++) {
+        job->out[count] = job->data[i];
+        count += job->pred(&job->data[i], job->ctx) ? 1 : 0;
+    }
+    job->count = count;
+    return NULL;
+}
+
+#if !RIFF_IS_EMPTY(COMBINE)
+
+RIFF_API(void*) RIFF_INST(par_internal_reduce_job, INSTANCE)(void* arg) {
+    JOB* job = (JOB*)arg;
+
+    // local accumulator, jobs of neighbouring threads share cache lines
+    STORED acc = job->data[0];
+    for (size_t i = 1; i < job->size; i++) COMBINE(&acc, &job->data[i]);
+    job->acc = acc;
+    return NULL;
+}
+
+RIFF_API(void*) RIFF_INST(par_internal_scan_job, INSTANCE)(void* arg) {
+    JOB* job = (JOB*)arg;
+    size_t i = 0;
+
+    STORED acc;
+    if (job->has_acc) acc = job->acc;
+    else              acc = job->data[i++];
+
+    for (; i < job->size; i++) {
+        COMBINE(&acc, &job->data[i]);
+        job->data[i] = acc;
+    }
+    return NULL;
+}
+
+#endif
+
+/*
+    Operations
+*/
+
+// Sorts given buffer ascending, chunks are sorted in parallel with algo_sort()
+// and then merged pairwise, each merge is split between threads along merge path
+// Not stable, allocates temporary buffer of size elements
+// May fail (allocation), buffer is left unchanged then, O(n log n / threads + n log threads)
+#define par_sort(inst) RIFF_INST(par_sort, inst)
+
+RIFF_API(int) par_sort(INSTANCE)(STORED* data, size_t size, size_t threads) {
+    threads = riff_par_threads(threads, size);
+    if (threads == 1) {
+        algo_sort(INSTANCE)(data, size);
+        return SCC;
+    }
+
+    STORED* buff = (STORED*)RIFF_ALLOC(size * sizeof(STORED));
+    if (!buff) return ERR;
+
+    JOB    jobs[RIFF_PAR_MAX_THREADS];
+    size_t runs[RIFF_PAR_MAX_THREADS + 1]; // run boundaries
+    size_t run_count = threads;
+
+    // sort chunks
+    for (size_t i = 0; i < threads; i++) {
+        runs[i]      = CHUNK_BEGIN(i, threads, size);
+        jobs[i].data = data + runs[i];
+        jobs[i].size = CHUNK_BEGIN(i + 1, threads, size) - runs[i];
+    }
+    runs[threads] = size;
+    riff_par_run(RIFF_INST(par_internal_sort_job, INSTANCE), jobs, sizeof(JOB), threads);
+
+    // merge pairs of runs, ping-ponging between data and buffer
+    STORED* src = data;
+    STORED* dst = buff;
+    while (run_count > 1) {
+        size_t pairs   = run_count / 2;
+        size_t per     = threads / pairs ? threads / pairs : 1;
+        size_t job_cnt = 0;
+
+        for (size_t p = 0; p < pairs; p++) {
+            size_t a_beg = runs[2 * p], b_beg = runs[2 * p + 1], end = runs[2 * p + 2];
+            const STORED* a = src + a_beg; size_t size_a = b_beg - a_beg;
+            const STORED* b = src + b_beg; size_t size_b = end - b_beg;
+
+            // split output of this merge into per parts
+            size_t i_prev = 0, k_prev = 0;
+            for (size_t w = 1; w <= per; w++) {
+                size_t k = CHUNK_BEGIN(w, per, size_a + size_b);
+                size_t i = RIFF_INST(par_internal_co_rank, INSTANCE)(k, a, size_a, b, size_b);
+
+                jobs[job_cnt].data       = (STORED*)a + i_prev;
+                jobs[job_cnt].size       = i - i_prev;
+                jobs[job_cnt].other      = b + (k_prev - i_prev);
+                jobs[job_cnt].other_size = (k - i) - (k_prev - i_prev);
+                jobs[job_cnt].out        = dst + a_beg + k_prev;
+                job_cnt++;
+
+                i_prev = i;
+                k_prev = k;
+            }
+        }
+
+        // odd run out, just copy it
+        if (run_count % 2) {
+            size_t beg = runs[run_count - 1];
+            memcpy(dst + beg, src + beg, (size - beg) * sizeof(STORED));
+        }
+
+        riff_par_run(RIFF_INST(par_internal_merge_job, INSTANCE), jobs, sizeof(JOB), job_cnt);
+
+        // drop boundaries of merged runs
+        for (size_t p = 0; p <= pairs; p++) runs[p] = runs[2 * p < run_count ? 2 * p : run_count];
+        run_count -= pairs;
+        runs[run_count] = size;
+
+        STORED* tmp = src; src = dst; dst = tmp;
+    }
+
+    if (src != data) memcpy(data, src, size * sizeof(STORED));
+    RIFF_FREE(buff);
+    return SCC;
+}
+
+// Calls func(element, ctx) on every element of the buffer, elements are split between threads
+// func must be safe to call concurrently
+// O(n / threads)
+#define par_map(inst) RIFF_INST(par_map, inst)
+
+RIFF_API(void) par_map(INSTANCE)(
+    STORED* data, size_t size, size_t threads,
+    void (*func)(STORED* elem, void* ctx), void* ctx
+) {
+    threads = riff_par_threads(threads, size);
+
+    JOB jobs[RIFF_PAR_MAX_THREADS];
+    for (size_t i = 0; i < threads; i++) {
+        size_t beg = CHUNK_BEGIN(i, threads, size);
+        jobs[i].data = data + beg;
+        jobs[i].size = CHUNK_BEGIN(i + 1, threads, size) - beg;
+        jobs[i].map  = func;
+        jobs[i].ctx  = ctx;
+    }
+    riff_par_run(RIFF_INST(par_internal_map_job, INSTANCE), jobs, sizeof(JOB), threads);
+}
+
+// Appends elements for which pred(element, ctx) returns non-0 to out, preserving their order
+// Elements are shallow copied - out does not become the only owner, mind destructors
+// pred must be safe to call concurrently
+// Reserves capacity for all size elements in out, shrink out afterwards if needed
+// May fail (allocation), out is left unchanged then, O(n / threads + matches)
+#define par_filter(inst) RIFF_INST(par_filter, inst)
+
+RIFF_API(int) par_filter(INSTANCE)(
+    const STORED* data, size_t size, size_t threads,
+    int (*pred)(const STORED* elem, void* ctx), void* ctx,
+    dyarr(INSTANCE)* out
+) {
+    size_t old_size = dyarr_size(INSTANCE)(out);
+    if (dyarr_reserve(INSTANCE)(out, old_size + size) == ERR) return ERR;
+
+    // every thread compacts its chunk at chunk's own offset in out's tail
+    STORED* tail = dyarr_access(INSTANCE)(out) + old_size;
+    threads = riff_par_threads(threads, size);
+
+    JOB jobs[RIFF_PAR_MAX_THREADS];
+    for (size_t i = 0; i < threads; i++) {
+        size_t beg = CHUNK_BEGIN(i, threads, size);
+        jobs[i].data = (STORED*)data + beg;
+        jobs[i].size = CHUNK_BEGIN(i + 1, threads, size) - beg;
+        jobs[i].out  = tail + beg;
+        jobs[i].pred = pred;
+        jobs[i].ctx  = ctx;
+    }
+    riff_par_run(RIFF_INST(par_internal_filter_job, INSTANCE), jobs, sizeof(JOB), threads);
+
+    // close gaps between chunks
+    size_t total = jobs[0].count;
+    for (size_t i = 1; i < threads; i++) {
+        memmove(tail + total, jobs[i].out, jobs[i].count * sizeof(STORED));
+        total += jobs[i].count;
+    }
+
+    dyarr_extend(INSTANCE)(out, total); // capacity already reserved, cannot fail
+    return SCC;
+}
+
+#if !RIFF_IS_EMPTY(COMBINE)
+
+// Combines all elements of the buffer into *out, in order (op needs to be associative, not commutative)
+// Chunks are reduced in parallel, then partial results are combined
+// May fail (empty buffer), O(n / threads + threads)
+#define par_reduce(inst) RIFF_INST(par_reduce, inst)
+
+RIFF_API(int) par_reduce(INSTANCE)(const STORED* data, size_t size, size_t threads, STORED* out) {
+    if (size == 0) return ERR;
+    threads = riff_par_threads(threads, size);
+
+    JOB jobs[RIFF_PAR_MAX_THREADS];
+    for (size_t i = 0; i < threads; i++) {
+        size_t beg = CHUNK_BEGIN(i, threads, size);
+        jobs[i].data = (STORED*)data + beg;
+        jobs[i].size = CHUNK_BEGIN(i + 1, threads, size) - beg;
+    }
+    riff_par_run(RIFF_INST(par_internal_reduce_job, INSTANCE), jobs, sizeof(JOB), threads);
+
+    STORED acc = jobs[0].acc;
+    for (size_t i = 1; i < threads; i++) COMBINE(&acc, &jobs[i].acc);
+    *out = acc;
+    return SCC;
+}
+
+// Replaces every element with combination of all elements up to and including it (inclusive scan)
+// Chunks are reduced in parallel, their prefixes are combined serially and then chunks are scanned in parallel
+// O(n / threads + threads)
+#define par_prefix_sum(inst) RIFF_INST(par_prefix_sum, inst)
+
+RIFF_API(void) par_prefix_sum(INSTANCE)(STORED* data, size_t size, size_t threads) {
+    if (size == 0) return;
+    threads = riff_par_threads(threads, size);
+
+    JOB jobs[RIFF_PAR_MAX_THREADS];
+    for (size_t i = 0; i < threads; i++) {
+        size_t beg = CHUNK_BEGIN(i, threads, size);
+        jobs[i].data = data + beg;
+        jobs[i].size = CHUNK_BEGIN(i + 1, threads, size) - beg;
+    }
+
+    jobs[0].has_acc = 0;
+
+    if (threads > 1) {
+        // totals of all chunks but the last one
+        riff_par_run(RIFF_INST(par_internal_reduce_job, INSTANCE), jobs, sizeof(JOB), threads - 1);
+
+        // turn totals into offsets, first chunk has none
+        STORED offset = jobs[0].acc;
+        for (size_t i = 1; i < threads; i++) {
+            jobs[i].has_acc = 1;
+            if (i + 1 < threads) {
+                STORED total = jobs[i].acc;
+                jobs[i].acc = offset;
+                COMBINE(&offset, &total);
+            }
+            else jobs[i].acc = offset;
+        }
+    }
+
+    riff_par_run(RIFF_INST(par_internal_scan_job, INSTANCE), jobs, sizeof(JOB), threads);
+}
+
+#endif
+
+#undef JOB
+#undef CHUNK_BEGIN
+
+#undef INSTANCE
+#undef STORED
+#undef LESS
+#undef COMBINE
+
+// consume parameters
+#undef T
+#undef A
@@ -1,10 +1,16 @@
 /*
     T macro pattern
         [instance name], [stored type], [stored type destructor (opt)]
+
+    Without destructor the stored type is trivial, element destruction loops are compiled out
+    Elements are moved with memcpy, as every stored object is (shallow copy ownership)
+    Define RIFF_STATS before inclusion to collect counters, see queue_stats()
 */
 
 #include "generic.h"
 
+#include <string.h>
+
 #ifndef T
     #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
 #endif
@@ -20,6 +26,33 @@
 #define INSTANCE   RIFF_FIRST(T)
 #define STORED     RIFF_SECOND(T)
 #define DESTRUCTOR RIFF_THIRD(T)
+#define TRIVIAL    RIFF_IS_EMPTY(DESTRUCTOR)
+
+#if TRIVIAL
+    #define DESTROY(ptr)
+#else
+    #define DESTROY(ptr) DESTRUCTOR(ptr)
+#endif
+
+#ifdef RIFF_STATS
+    #define STAT(...) __VA_ARGS__
+#else
+    #define STAT(...)
+#endif
+
+#define STAT_ALLOC(tar, bytes) STAT((tar)->priv_stats.grows++; (tar)->priv_stats.bytes_allocated += (bytes);)
+
+#if defined(RIFF_STATS) && !defined(RIFF_QUEUE_STATS)
+#define RIFF_QUEUE_STATS
+
+// Queue counters, collected when RIFF_STATS is defined
+typedef struct riff_queue_stats {
+    size_t grows;           // buffer (re)allocations
+    size_t wrap_grows;      // grows of a wrapped buffer, which copy every element, O(n)
+    size_t bytes_allocated; // bytes requested from the allocator in total
+    size_t peak_size;       // highest count of elements
+} riff_queue_stats;
+#endif
 
 /*
     Typedef
@@ -35,6 +68,9 @@ typedef struct queue(INSTANCE) {
     size_t  priv_end;   // inc
     size_t  priv_capc;
     STORED* priv_data;
+#ifdef RIFF_STATS
+    riff_queue_stats priv_stats;
+#endif
 } queue(INSTANCE);
 
 /*
@@ -50,6 +86,7 @@ RIFF_API(void) queue_zero(INSTANCE)(queue(INSTANCE)* tar) {
     tar->priv_end   = 0;
     tar->priv_capc  = 0;
     tar->priv_data = NULL;
+    STAT(riff_queue_stats zero_stats = { 0 }; tar->priv_stats = zero_stats;)
 }
 
 // Properly destroys given queue
@@ -57,12 +94,14 @@ RIFF_API(void) queue_zero(INSTANCE)(queue(INSTANCE)* tar) {
 #define queue_destroy(inst) RIFF_INST(queue_destroy, inst)
 
 RIFF_API(void) queue_destroy(INSTANCE)(queue(INSTANCE)* tar) {
+#if !TRIVIAL
     if (tar->priv_data) {
         while (tar->priv_front != tar->priv_end) {
             DESTRUCTOR(&tar->priv_data[tar->priv_front]);
             tar->priv_front = (tar->priv_front + 1) % tar->priv_capc;
         }
     }
+#endif
 
     RIFF_FREE(tar->priv_data);
     queue_zero(INSTANCE)(tar);
@@ -102,9 +141,10 @@ RIFF_API(int) queue_push(INSTANCE)(queue(INSTANCE)* tar, STORED val) {
     // queue 0-init
     if (tar->priv_capc == 0) {
         size_t  new_capc = 4;
-        STORED* new_data = RIFF_ALLOC(new_capc * sizeof(STORED));
+        STORED* new_data = (STORED*)RIFF_ALLOC(new_capc * sizeof(STORED));
 
         if (!new_data) return ERR;
+        STAT_ALLOC(tar, new_capc * sizeof(STORED));
 
         tar->priv_capc = new_capc;
         tar->priv_data = new_data;
@@ -114,9 +154,10 @@ RIFF_API(int) queue_push(INSTANCE)(queue(INSTANCE)* tar, STORED val) {
         // can realloc without invalidation (elements order == memory order), O(1) case
         if (tar->priv_front <= tar->priv_end) {
             size_t  new_capc = tar->priv_capc * 2;
-            STORED* new_data = RIFF_REALLOC(tar->priv_data, new_capc * sizeof(STORED));
+            STORED* new_data = (STORED*)RIFF_REALLOC(tar->priv_data, new_capc * sizeof(STORED));
 
             if (!new_data) return ERR;
+            STAT_ALLOC(tar, new_capc * sizeof(STORED));
             
             tar->priv_capc = new_capc;
             tar->priv_data = new_data;
@@ -124,13 +165,17 @@ RIFF_API(int) queue_push(INSTANCE)(queue(INSTANCE)* tar, STORED val) {
         // cannot call realloc without invalidation O(n) case
         else {
             size_t  new_capc = tar->priv_capc * 2;
-            STORED* new_data = RIFF_ALLOC(new_capc * sizeof(STORED));
+            STORED* new_data = (STORED*)RIFF_ALLOC(new_capc * sizeof(STORED));
 
             if (!new_data) return ERR;
+            STAT_ALLOC(tar, new_capc * sizeof(STORED));
+            STAT(tar->priv_stats.wrap_grows++;)
             
-            // move elements
+            // move elements, front segment up to the buffer end then the wrapped one
             size_t size = queue_size(INSTANCE)(tar);
-            for (size_t i = 0; i < size; i++) new_data[i] = tar->priv_data[(tar->priv_front + i) % tar->priv_capc];
+            size_t head = tar->priv_capc - tar->priv_front;
+            memcpy(new_data, tar->priv_data + tar->priv_front, head * sizeof(STORED));
+            memcpy(new_data + head, tar->priv_data, tar->priv_end * sizeof(STORED));
             
             RIFF_FREE(tar->priv_data);
 
@@ -144,6 +189,10 @@ RIFF_API(int) queue_push(INSTANCE)(queue(INSTANCE)* tar, STORED val) {
     // push back
     tar->priv_data[tar->priv_end] = val;
     tar->priv_end = (tar->priv_end + 1) % tar->priv_capc;
+    STAT(
+        size_t size = queue_size(INSTANCE)(tar);
+        if (size > tar->priv_stats.peak_size) tar->priv_stats.peak_size = size;
+    )
 
     return SCC;
 }
@@ -169,7 +218,7 @@ RIFF_API(int) queue_pop(INSTANCE)(queue(INSTANCE)* tar, STORED* out) {
 
     // tranfer or destroy
     if (out) *out = tar->priv_data[tar->priv_front];
-    else     DESTRUCTOR(&tar->priv_data[tar->priv_front]);
+    else     { DESTROY(&tar->priv_data[tar->priv_front]); }
 
     // move on
     tar->priv_front++;
@@ -178,6 +227,30 @@ RIFF_API(int) queue_pop(INSTANCE)(queue(INSTANCE)* tar, STORED* out) {
     return SCC;
 }
 
+#ifdef RIFF_STATS
+/*
+    Statistics
+*/
+
+// Returns counters collected since the queue was zeroed / destroyed
+// Only defined when RIFF_STATS is defined before inclusion
+// O(1)
+#define queue_stats(inst) RIFF_INST(queue_stats, inst)
+
+RIFF_API(riff_queue_stats) queue_stats(INSTANCE)(const queue(INSTANCE)* tar) {
+    return tar->priv_stats;
+}
+#endif
+
+#undef DESTROY
+#undef STAT
+#undef STAT_ALLOC
+
+#undef INSTANCE
+#undef STORED
+#undef DESTRUCTOR
+#undef TRIVIAL
+
 // consume parameters
 #undef T
 #undef A
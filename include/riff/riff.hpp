@@ -0,0 +1,997 @@
+/*
+    C++ wrappers
+
+    Not a T macro header - class templates with the layouts and algorithms of the C containers,
+    without the per-type #define T / #include dance:
+        riff::dyarr<T, Alloc>
+        riff::queue<T, Alloc>
+        riff::dlist<T, Alloc>
+        riff::hhmap<K, V, Hash, Eq, Alloc>
+
+    Containers destroy their elements when they go out of scope, are movable but not copyable,
+    and provide iterators usable by range-for and <algorithm>
+    Failures follow the C convention - false / nullptr result and the container stays unchanged, nothing is thrown
+    Trivially copyable types take the C paths (realloc, memcpy, no destruction), other types are
+    move constructed and destroyed one by one, so std::string and alike are safe to store,
+    their move constructors and move assignments must not throw
+
+    Alloc is a type with static alloc / realloc / free functions, riff::allocator makes one from an A triple:
+        using tracked = riff::allocator<track_alloc(t), track_realloc(t), track_free(t)>;
+
+    Can be included together with the C headers, their dyarr(inst) style macros are suspended inside
+*/
+
+#pragma once
+
+#include "hash.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#pragma push_macro("dyarr")
+#pragma push_macro("queue")
+#pragma push_macro("dlist")
+#pragma push_macro("hhmap")
+#undef dyarr
+#undef queue
+#undef dlist
+#undef hhmap
+
+namespace riff {
+
+/*
+    Allocators
+*/
+
+// stdlib heap allocator, the default of every container
+struct std_alloc {
+    static void* alloc(size_t size)              { return std::malloc(size); }
+    static void* realloc(void* ptr, size_t size) { return std::realloc(ptr, size); }
+    static void  free(void* ptr)                 { std::free(ptr); }
+};
+
+// allocator from an A triple of functions
+template <void* (*Alloc)(size_t), void* (*Realloc)(void*, size_t), void (*Free)(void*)>
+struct allocator {
+    static void* alloc(size_t size)              { return Alloc(size); }
+    static void* realloc(void* ptr, size_t size) { return Realloc(ptr, size); }
+    static void  free(void* ptr)                 { Free(ptr); }
+};
+
+/*
+    Hash
+*/
+
+// Default hash of hhmap - std::hash finalized with riff_mix64 (std::hash of integers is usually identity),
+// strings hashed by riff_hash_bytes, all with RIFF_HASH_SEED
+template <class K>
+struct hash {
+    size_t operator()(const K& key) const noexcept {
+        uint64_t h = (uint64_t)std::hash<K>()(key);
+        return (size_t)(RIFF_HASH_SEED ? riff_mix64_seeded(h, RIFF_HASH_SEED) : riff_mix64(h));
+    }
+};
+
+template <>
+struct hash<std::string_view> {
+    size_t operator()(std::string_view key) const noexcept {
+        return (size_t)riff_hash_bytes(key.data(), key.size(), RIFF_HASH_SEED);
+    }
+};
+
+template <>
+struct hash<std::string> {
+    size_t operator()(const std::string& key) const noexcept {
+        return (size_t)riff_hash_bytes(key.data(), key.size(), RIFF_HASH_SEED);
+    }
+};
+
+/*
+    Helpers
+*/
+
+namespace detail {
+
+template <class T>
+constexpr bool trivial = std::is_trivially_copyable_v<T>;
+
+template <class T>
+void check_stored() {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "riff containers require nothrow move constructible types");
+    static_assert(std::is_nothrow_move_assignable_v<T>, "riff containers require nothrow move assignable types");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "riff containers do not support over-aligned types");
+}
+
+// destroys objects of [beg, end)
+template <class T>
+void destroy(T* beg, T* end) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (; beg < end; beg++) beg->~T();
+    }
+}
+
+// moves count objects from src into uninitialized dst, sources are destroyed
+template <class T>
+void relocate(T* dst, T* src, size_t count) noexcept {
+    if constexpr (trivial<T>) {
+        if (count) std::memcpy((void*)dst, (const void*)src, count * sizeof(T));
+    }
+    else {
+        for (size_t i = 0; i < count; i++) {
+            ::new ((void*)(dst + i)) T(std::move(src[i]));
+            src[i].~T();
+        }
+    }
+}
+
+// resizes block to capacity objects keeping live objects of [first, first + count) at their indices
+// returns nullptr on failure, the block is untouched then
+template <class T, class Alloc>
+T* reallocate(T* data, size_t first, size_t count, size_t capacity) noexcept {
+    if constexpr (trivial<T>) {
+        return (T*)Alloc::realloc((void*)data, capacity * sizeof(T));
+    }
+    else {
+        T* out = (T*)Alloc::alloc(capacity * sizeof(T));
+        if (!out) return nullptr;
+        relocate(out + first, data + first, count);
+        Alloc::free(data);
+        return out;
+    }
+}
+
+} // namespace detail
+
+/*
+    Dynamic Array
+*/
+
+// Dynamic Array (dyarr)
+// Contiguous, doubling on a push into a full array, iterators are pointers
+// O(n) memory complexity
+template <class T, class Alloc = std_alloc>
+class dyarr {
+public:
+    using value_type     = T;
+    using size_type      = size_t;
+    using iterator       = T*;
+    using const_iterator = const T*;
+
+    dyarr() noexcept { detail::check_stored<T>(); }
+    dyarr(const dyarr&) = delete;
+    dyarr& operator=(const dyarr&) = delete;
+
+    dyarr(dyarr&& other) noexcept { swap(other); }
+
+    dyarr& operator=(dyarr&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~dyarr() { destroy(); }
+
+    void swap(dyarr& other) noexcept {
+        std::swap(size_, other.size_);
+        std::swap(capc_, other.capc_);
+        std::swap(data_, other.data_);
+    }
+
+    // Destroys elements and frees memory, the array is empty afterwards
+    // O(n) if T is not trivially destructible, O(1) otherwise
+    void destroy() noexcept {
+        detail::destroy(data_, data_ + size_);
+        Alloc::free(data_);
+        size_ = 0;
+        capc_ = 0;
+        data_ = nullptr;
+    }
+
+    // Ensures the array has at least given capacity (in total, not left)
+    // May fail, O(1) else reallocation time complexity
+    bool reserve(size_t capacity) noexcept {
+        if (capc_ >= capacity) return true;
+        return resize_block(capacity);
+    }
+
+    // Reallocates memory into a block which tightly fits the elements
+    // May fail, O(1) else reallocation time complexity
+    bool shrink_to_fit() noexcept {
+        if (capc_ == size_) return true;
+        if (size_ == 0) {
+            destroy();
+            return true;
+        }
+        return resize_block(size_);
+    }
+
+    size_t size() const noexcept     { return size_; }
+    size_t capacity() const noexcept { return capc_; }
+    bool   empty() const noexcept    { return size_ == 0; }
+
+    T*       data() noexcept       { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    T&       operator[](size_t i) noexcept       { return data_[i]; }
+    const T& operator[](size_t i) const noexcept { return data_[i]; }
+
+    iterator       begin() noexcept       { return data_; }
+    iterator       end() noexcept         { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept   { return data_ + size_; }
+
+    // Pushes new element constructed from args, args must not refer into the array
+    // May fail, O(1) average
+    template <class... Args>
+    bool emplace(Args&&... args) {
+        if (size_ >= capc_ && !resize_block(capc_ ? capc_ * 2 : 1)) return false;
+        ::new ((void*)(data_ + size_)) T(std::forward<Args>(args)...);
+        size_++;
+        return true;
+    }
+
+    // Pushes element, value may be an element of the array
+    // May fail, O(1) average
+    bool push(T value) noexcept {
+        return emplace(std::move(value));
+    }
+
+    // Grows array by amount elements, returns pointer to the first new one (NULL on failure)
+    // Trivially default constructible elements are left uninitialized as in C, others are value initialized
+    // May fail, O(1) else reallocation time complexity, O(amount) for non-trivial types
+    T* extend(size_t amount) {
+        if (size_ + amount > capc_) {
+            size_t new_capc = capc_ * 2;
+            if (new_capc < size_ + amount) new_capc = size_ + amount;
+            if (!resize_block(new_capc)) return nullptr;
+        }
+
+        T* first = data_ + size_;
+        if constexpr (!std::is_trivially_default_constructible_v<T>) {
+            for (size_t i = 0; i < amount; i++) ::new ((void*)(first + i)) T();
+        }
+        size_ += amount;
+        return first;
+    }
+
+    // Pops last element, moved into *out if out is not NULL, destroyed otherwise
+    // May fail (nothing to pop), O(1)
+    bool pop(T* out = nullptr) noexcept {
+        if (size_ == 0) return false;
+        size_--;
+        if (out) *out = std::move(data_[size_]);
+        data_[size_].~T();
+        return true;
+    }
+
+    // Pops last amount elements, moved into out in order if out is not NULL, destroyed otherwise
+    // May fail (not enough elements to pop), O(amount)
+    bool pop_many(T* out, size_t amount) noexcept {
+        if (size_ < amount) return false;
+        size_t first = size_ - amount;
+
+        if constexpr (detail::trivial<T>) {
+            if (out && amount) std::memcpy((void*)out, (const void*)(data_ + first), amount * sizeof(T));
+        }
+        else if (out) {
+            for (size_t i = 0; i < amount; i++) out[i] = std::move(data_[first + i]);
+        }
+        detail::destroy(data_ + first, data_ + size_);
+
+        size_ = first;
+        return true;
+    }
+
+    // Destroys elements, keeps capacity
+    // O(n) if T is not trivially destructible, O(1) otherwise
+    void clear() noexcept {
+        detail::destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+private:
+    bool resize_block(size_t capacity) noexcept {
+        T* new_data = detail::reallocate<T, Alloc>(data_, 0, size_, capacity);
+        if (!new_data) return false;
+        data_ = new_data;
+        capc_ = capacity;
+        return true;
+    }
+
+    size_t size_ = 0;
+    size_t capc_ = 0;
+    T*     data_ = nullptr;
+};
+
+/*
+    Queue
+*/
+
+// Queue (queue)
+// Circular buffer, O(1) push and pop, random access iterators from front to back
+// O(n) memory complexity
+template <class T, class Alloc = std_alloc>
+class queue {
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+
+        basic_iterator() noexcept = default;
+        basic_iterator(const queue* q, size_t i) noexcept : q_(q), i_(i) {}
+
+        template <bool C = Const, class = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept : q_(other.q_), i_(other.i_) {}
+
+        reference operator*() const noexcept                    { return q_->data_[(q_->front_ + i_) % q_->capc_]; }
+        pointer   operator->() const noexcept                   { return &**this; }
+        reference operator[](difference_type n) const noexcept  { return *(*this + n); }
+
+        basic_iterator& operator++() noexcept    { i_++; return *this; }
+        basic_iterator& operator--() noexcept    { i_--; return *this; }
+        basic_iterator  operator++(int) noexcept { basic_iterator r = *this; i_++; return r; }
+        basic_iterator  operator--(int) noexcept { basic_iterator r = *this; i_--; return r; }
+
+        basic_iterator& operator+=(difference_type n) noexcept { i_ += n; return *this; }
+        basic_iterator& operator-=(difference_type n) noexcept { i_ -= n; return *this; }
+
+        friend basic_iterator  operator+(basic_iterator a, difference_type n) noexcept { return a += n; }
+        friend basic_iterator  operator+(difference_type n, basic_iterator a) noexcept { return a += n; }
+        friend basic_iterator  operator-(basic_iterator a, difference_type n) noexcept { return a -= n; }
+        friend difference_type operator-(basic_iterator a, basic_iterator b) noexcept  { return (difference_type)(a.i_ - b.i_); }
+
+        friend bool operator==(basic_iterator a, basic_iterator b) noexcept { return a.i_ == b.i_; }
+        friend bool operator!=(basic_iterator a, basic_iterator b) noexcept { return a.i_ != b.i_; }
+        friend bool operator<(basic_iterator a, basic_iterator b) noexcept  { return a.i_ < b.i_; }
+        friend bool operator>(basic_iterator a, basic_iterator b) noexcept  { return a.i_ > b.i_; }
+        friend bool operator<=(basic_iterator a, basic_iterator b) noexcept { return a.i_ <= b.i_; }
+        friend bool operator>=(basic_iterator a, basic_iterator b) noexcept { return a.i_ >= b.i_; }
+
+    private:
+        friend class basic_iterator<!Const>;
+
+        const queue* q_ = nullptr;
+        size_t       i_ = 0; // position from the front
+    };
+
+public:
+    using value_type     = T;
+    using size_type      = size_t;
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    queue() noexcept { detail::check_stored<T>(); }
+    queue(const queue&) = delete;
+    queue& operator=(const queue&) = delete;
+
+    queue(queue&& other) noexcept { swap(other); }
+
+    queue& operator=(queue&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~queue() { destroy(); }
+
+    void swap(queue& other) noexcept {
+        std::swap(front_, other.front_);
+        std::swap(end_, other.end_);
+        std::swap(capc_, other.capc_);
+        std::swap(data_, other.data_);
+    }
+
+    // Destroys elements and frees memory, the queue is empty afterwards
+    // O(n) if T is not trivially destructible, O(1) otherwise
+    void destroy() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (; front_ != end_; front_ = (front_ + 1) % capc_) data_[front_].~T();
+        }
+        Alloc::free(data_);
+        front_ = 0;
+        end_   = 0;
+        capc_  = 0;
+        data_  = nullptr;
+    }
+
+    bool empty() const noexcept { return front_ == end_; }
+
+    size_t size() const noexcept {
+        return front_ <= end_ ? end_ - front_ : capc_ - front_ + end_;
+    }
+
+    iterator       begin() noexcept       { return iterator(this, 0); }
+    iterator       end() noexcept         { return iterator(this, size()); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept   { return const_iterator(this, size()); }
+
+    // Pushes element constructed from args at the queue's end, args must not refer into the queue
+    // May fail (if need to alloc / realloc circular buffer), O(1) avg
+    template <class... Args>
+    bool emplace(Args&&... args) {
+        if (capc_ == 0) {
+            T* new_data = (T*)Alloc::alloc(4 * sizeof(T));
+            if (!new_data) return false;
+            capc_ = 4;
+            data_ = new_data;
+        }
+        else if ((end_ + 1) % capc_ == front_ && !grow()) return false;
+
+        ::new ((void*)(data_ + end_)) T(std::forward<Args>(args)...);
+        end_ = (end_ + 1) % capc_;
+        return true;
+    }
+
+    // Pushes element at the queue's end
+    // May fail (if need to alloc / realloc circular buffer), O(1) avg
+    bool push(T value) noexcept {
+        return emplace(std::move(value));
+    }
+
+    // Returns pointer to the element at the queue's front, NULL if empty
+    // O(1)
+    T*       top() noexcept       { return empty() ? nullptr : data_ + front_; }
+    const T* top() const noexcept { return empty() ? nullptr : data_ + front_; }
+
+    // Pops the front element, moved into *out if out is not NULL, destroyed otherwise
+    // May fail (empty queue), O(1)
+    bool pop(T* out = nullptr) noexcept {
+        if (empty()) return false;
+        if (out) *out = std::move(data_[front_]);
+        data_[front_].~T();
+        front_ = (front_ + 1) % capc_;
+        return true;
+    }
+
+private:
+    // doubles the full buffer, O(1) unless wrapped (or T is not trivially copyable), O(n) otherwise
+    bool grow() noexcept {
+        size_t new_capc = capc_ * 2;
+
+        // elements order == memory order, realloc keeps indices
+        if (front_ <= end_) {
+            T* new_data = detail::reallocate<T, Alloc>(data_, front_, end_ - front_, new_capc);
+            if (!new_data) return false;
+            data_ = new_data;
+            capc_ = new_capc;
+            return true;
+        }
+
+        // wrapped, front segment up to the buffer end then the wrapped one
+        T* new_data = (T*)Alloc::alloc(new_capc * sizeof(T));
+        if (!new_data) return false;
+
+        size_t size = this->size();
+        size_t head = capc_ - front_;
+        detail::relocate(new_data, data_ + front_, head);
+        detail::relocate(new_data + head, data_, end_);
+        Alloc::free(data_);
+
+        data_  = new_data;
+        capc_  = new_capc;
+        front_ = 0;
+        end_   = size;
+        return true;
+    }
+
+    size_t front_ = 0; // inc
+    size_t end_   = 0; // exc
+    size_t capc_  = 0;
+    T*     data_  = nullptr;
+};
+
+/*
+    Doubly linked list
+*/
+
+// Double-linked list (dlist)
+// Node pointers stay valid until their node is popped, bidirectional iterators
+// O(n) memory complexity
+template <class T, class Alloc = std_alloc>
+class dlist {
+public:
+    // list node, holds the element
+    class node {
+    public:
+        T&       value() noexcept       { return obj_; }
+        const T& value() const noexcept { return obj_; }
+        node*    next() const noexcept  { return next_; }
+        node*    prev() const noexcept  { return prev_; }
+
+    private:
+        friend class dlist;
+
+        template <class... Args>
+        explicit node(Args&&... args) : obj_(std::forward<Args>(args)...) {}
+
+        T     obj_;
+        node* prev_;
+        node* next_;
+    };
+
+private:
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+
+        basic_iterator() noexcept = default;
+        basic_iterator(const dlist* l, node* n) noexcept : l_(l), n_(n) {}
+
+        template <bool C = Const, class = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept : l_(other.l_), n_(other.n_) {}
+
+        // node of the element, NULL for end()
+        node* get_node() const noexcept { return n_; }
+
+        reference operator*() const noexcept  { return n_->value(); }
+        pointer   operator->() const noexcept { return &n_->value(); }
+
+        basic_iterator& operator++() noexcept    { n_ = n_->next(); return *this; }
+        basic_iterator& operator--() noexcept    { n_ = n_ ? n_->prev() : l_->last_; return *this; }
+        basic_iterator  operator++(int) noexcept { basic_iterator r = *this; ++*this; return r; }
+        basic_iterator  operator--(int) noexcept { basic_iterator r = *this; --*this; return r; }
+
+        friend bool operator==(basic_iterator a, basic_iterator b) noexcept { return a.n_ == b.n_; }
+        friend bool operator!=(basic_iterator a, basic_iterator b) noexcept { return a.n_ != b.n_; }
+
+    private:
+        friend class basic_iterator<!Const>;
+
+        const dlist* l_ = nullptr;
+        node*        n_ = nullptr;
+    };
+
+public:
+    using value_type     = T;
+    using size_type      = size_t;
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    dlist() noexcept { detail::check_stored<T>(); }
+    dlist(const dlist&) = delete;
+    dlist& operator=(const dlist&) = delete;
+
+    dlist(dlist&& other) noexcept { swap(other); }
+
+    dlist& operator=(dlist&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~dlist() { destroy(); }
+
+    void swap(dlist& other) noexcept {
+        std::swap(size_, other.size_);
+        std::swap(first_, other.first_);
+        std::swap(last_, other.last_);
+    }
+
+    // Destroys elements and frees nodes, the list is empty afterwards
+    // O(n)
+    void destroy() noexcept {
+        node* cur = first_;
+        while (cur) {
+            node* next = cur->next_;
+            cur->~node();
+            Alloc::free(cur);
+            cur = next;
+        }
+        size_  = 0;
+        first_ = nullptr;
+        last_  = nullptr;
+    }
+
+    // Same as destroy, lists hold no memory but their nodes
+    // O(n)
+    void clear() noexcept { destroy(); }
+
+    size_t size() const noexcept  { return size_; }
+    bool   empty() const noexcept { return size_ == 0; }
+
+    // first / last node, NULL if the list is empty
+    node* first() const noexcept { return first_; }
+    node* last() const noexcept  { return last_; }
+
+    iterator       begin() noexcept       { return iterator(this, first_); }
+    iterator       end() noexcept         { return iterator(this, nullptr); }
+    const_iterator begin() const noexcept { return const_iterator(this, first_); }
+    const_iterator end() const noexcept   { return const_iterator(this, nullptr); }
+
+    // Inserts element constructed from args before the "before" node, NULL before pushes at the end
+    // May fail allocation, returns NULL on fail, the new node otherwise, O(1)
+    template <class... Args>
+    node* emplace_before(node* before, Args&&... args) {
+        node* n = make(std::forward<Args>(args)...);
+        if (!n) return nullptr;
+
+        if (!before) {
+            n->prev_ = last_;
+            n->next_ = nullptr;
+            if (last_) last_->next_ = n;
+            else       first_ = n;
+            last_ = n;
+        }
+        else {
+            n->prev_ = before->prev_;
+            n->next_ = before;
+            if (before->prev_) before->prev_->next_ = n;
+            else               first_ = n;
+            before->prev_ = n;
+        }
+
+        size_++;
+        return n;
+    }
+
+    // Inserts element constructed from args after the "after" node, NULL after pushes at the begin
+    // May fail allocation, returns NULL on fail, the new node otherwise, O(1)
+    template <class... Args>
+    node* emplace_after(node* after, Args&&... args) {
+        node* n = make(std::forward<Args>(args)...);
+        if (!n) return nullptr;
+
+        if (!after) {
+            n->prev_ = nullptr;
+            n->next_ = first_;
+            if (first_) first_->prev_ = n;
+            else        last_ = n;
+            first_ = n;
+        }
+        else {
+            n->prev_ = after;
+            n->next_ = after->next_;
+            if (after->next_) after->next_->prev_ = n;
+            else              last_ = n;
+            after->next_ = n;
+        }
+
+        size_++;
+        return n;
+    }
+
+    node* push_before(node* before, T value) noexcept { return emplace_before(before, std::move(value)); }
+    node* push_after(node* after, T value) noexcept   { return emplace_after(after, std::move(value)); }
+
+    // Erases given node, its element moved into *out if out is not NULL, destroyed otherwise
+    // O(1)
+    void pop(node* n, T* out = nullptr) noexcept {
+        if (out) *out = std::move(n->obj_);
+
+        if (n->prev_) n->prev_->next_ = n->next_;
+        else          first_ = n->next_;
+
+        if (n->next_) n->next_->prev_ = n->prev_;
+        else          last_ = n->prev_;
+
+        size_--;
+        n->~node();
+        Alloc::free(n);
+    }
+
+private:
+    template <class... Args>
+    node* make(Args&&... args) {
+        void* mem = Alloc::alloc(sizeof(node));
+        if (!mem) return nullptr;
+
+        // throwing constructor of T is allowed here, do not leak the node
+        try {
+            return ::new (mem) node(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            Alloc::free(mem);
+            throw;
+        }
+    }
+
+    size_t size_  = 0;
+    node*  first_ = nullptr;
+    node*  last_  = nullptr;
+};
+
+/*
+    Hash map
+*/
+
+// Hash Map (hhmap)
+// Linear probing with tombstones, rebuilds at load factor 0.7 (items and tombstones), as the C hhmap
+// Hash and Eq are default constructed at every call, so they must be stateless
+// Iterators yield entries of references to the key and the value
+// O(n) memory complexity
+template <class K, class V, class Hash = hash<K>, class Eq = std::equal_to<K>, class Alloc = std_alloc>
+class hhmap {
+    enum : char { slot_none = 0, slot_full = 1, slot_tomb = 2 };
+
+    static constexpr size_t init_capc = 16;
+
+public:
+    // iteration entry, structured bindings give the key and the value
+    template <class VV>
+    struct entry {
+        const K& key;
+        VV&      value;
+    };
+
+private:
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = entry<std::conditional_t<Const, const V, V>>;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = value_type;
+        using pointer           = void;
+
+        basic_iterator() noexcept = default;
+        basic_iterator(const hhmap* m, size_t i) noexcept : m_(m), i_(i) { skip(); }
+
+        template <bool C = Const, class = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept : m_(other.m_), i_(other.i_) {}
+
+        reference operator*() const noexcept { return reference{ m_->keys_[i_], m_->values_[i_] }; }
+
+        const K& key() const noexcept { return m_->keys_[i_]; }
+        std::conditional_t<Const, const V&, V&> value() const noexcept { return m_->values_[i_]; }
+
+        basic_iterator& operator++() noexcept    { i_++; skip(); return *this; }
+        basic_iterator  operator++(int) noexcept { basic_iterator r = *this; ++*this; return r; }
+
+        friend bool operator==(basic_iterator a, basic_iterator b) noexcept { return a.i_ == b.i_; }
+        friend bool operator!=(basic_iterator a, basic_iterator b) noexcept { return a.i_ != b.i_; }
+
+    private:
+        friend class basic_iterator<!Const>;
+
+        void skip() noexcept {
+            while (i_ < m_->capc_ && m_->used_[i_] != slot_full) i_++;
+        }
+
+        const hhmap* m_ = nullptr;
+        size_t       i_ = 0; // slot
+    };
+
+public:
+    using key_type       = K;
+    using mapped_type    = V;
+    using size_type      = size_t;
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    hhmap() noexcept {
+        detail::check_stored<K>();
+        detail::check_stored<V>();
+    }
+    hhmap(const hhmap&) = delete;
+    hhmap& operator=(const hhmap&) = delete;
+
+    hhmap(hhmap&& other) noexcept { swap(other); }
+
+    hhmap& operator=(hhmap&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~hhmap() { destroy(); }
+
+    void swap(hhmap& other) noexcept {
+        std::swap(used_, other.used_);
+        std::swap(keys_, other.keys_);
+        std::swap(values_, other.values_);
+        std::swap(size_, other.size_);
+        std::swap(tombs_, other.tombs_);
+        std::swap(capc_, other.capc_);
+    }
+
+    // Destroys keys and values and frees memory, the map is empty afterwards
+    // O(n) if K or V is not trivially destructible, O(1) otherwise
+    void destroy() noexcept {
+        destroy_entries();
+        Alloc::free(used_);
+        Alloc::free(keys_);
+        Alloc::free(values_);
+        used_   = nullptr;
+        keys_   = nullptr;
+        values_ = nullptr;
+        size_   = 0;
+        tombs_  = 0;
+        capc_   = 0;
+    }
+
+    // Destroys keys and values, keeps capacity
+    // O(n)
+    void clear() noexcept {
+        destroy_entries();
+        if (capc_) std::memset(used_, slot_none, capc_);
+        size_  = 0;
+        tombs_ = 0;
+    }
+
+    size_t size() const noexcept     { return size_; }
+    size_t capacity() const noexcept { return capc_; }
+    bool   empty() const noexcept    { return size_ == 0; }
+
+    iterator       begin() noexcept       { return iterator(this, 0); }
+    iterator       end() noexcept         { return iterator(this, capc_); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept   { return const_iterator(this, capc_); }
+
+    // Rebuilds internal arrays with new_capacity slots
+    // May fail (new_capacity to small to fit, or allocation failure), O(n)
+    bool rehash(size_t new_capacity) noexcept {
+        if (new_capacity < size_ || (new_capacity == 0 && capc_)) return false;
+
+        char* used;
+        K*    keys;
+        V*    values;
+        if (!alloc_arrays(new_capacity, &used, &keys, &values)) return false;
+
+        // scatter entries, keys are unique and there are no tombstones
+        // so the first empty slot of the probe sequence is the place
+        for (size_t i = 0; i < capc_; i++) {
+            if (used_[i] != slot_full) continue;
+
+            size_t pos = Hash()(keys_[i]) % new_capacity;
+            while (used[pos] != slot_none) pos = (pos + 1) % new_capacity;
+
+            used[pos] = slot_full;
+            detail::relocate(keys + pos, keys_ + i, 1);
+            detail::relocate(values + pos, values_ + i, 1);
+        }
+
+        Alloc::free(used_);
+        Alloc::free(keys_);
+        Alloc::free(values_);
+        used_   = used;
+        keys_   = keys;
+        values_ = values;
+        tombs_  = 0;
+        capc_   = new_capacity;
+        return true;
+    }
+
+    // Inserts new or replaces value at given key
+    // May fail (if failed to resize), O(1) avg O(n) worst
+    bool push(K key, V value) noexcept {
+        if (capc_ == 0 && !rehash(init_capc)) return false;
+
+        // rebuild at load factor 0.7 of items and tombstones, twice as large if items alone exceed half of that
+        // if rebuild fails try to fit anyway - there still may be some free spots in the array
+        if ((size_ + tombs_ + 1) * 10 > capc_ * 7) rehash((size_ + 1) * 20 > capc_ * 7 ? capc_ * 2 : capc_);
+
+        size_t idx             = Hash()(key) % capc_;
+        size_t first_tombstone = (size_t)-1;
+
+        for (size_t i = 0; i < capc_; i++) {
+            size_t pos = (idx + i) % capc_;
+
+            if (used_[pos] == slot_full && Eq()(keys_[pos], key)) {
+                values_[pos] = std::move(value);
+                return true;
+            }
+            else if (used_[pos] == slot_tomb) {
+                if (first_tombstone == (size_t)-1) first_tombstone = pos;
+            }
+            else if (used_[pos] == slot_none) {
+                size_t insert_pos = first_tombstone != (size_t)-1 ? first_tombstone : pos;
+                if (insert_pos != pos) tombs_--;
+                used_[insert_pos] = slot_full;
+                ::new ((void*)(keys_ + insert_pos)) K(std::move(key));
+                ::new ((void*)(values_ + insert_pos)) V(std::move(value));
+                size_++;
+                return true;
+            }
+        }
+
+        // map full -> cannot push (happens if rehash fails multiple times)
+        return false;
+    }
+
+    // Returns pointer to the value at given key, NULL if there is no such key
+    // Changes of the map may invalidate it
+    // O(1) avg O(n) worst
+    V* find(const K& key) noexcept {
+        size_t pos = slot_of(key);
+        return pos != (size_t)-1 ? values_ + pos : nullptr;
+    }
+
+    const V* find(const K& key) const noexcept {
+        size_t pos = slot_of(key);
+        return pos != (size_t)-1 ? values_ + pos : nullptr;
+    }
+
+    // Removes given key, its value moved into *out if out is not NULL, destroyed otherwise
+    // May fail (if no given key), O(1) avg O(n) worst
+    bool pop(const K& key, V* out = nullptr) noexcept {
+        size_t pos = slot_of(key);
+        if (pos == (size_t)-1) return false;
+
+        if (out) *out = std::move(values_[pos]);
+        values_[pos].~V();
+        keys_[pos].~K();
+        used_[pos] = slot_tomb;
+        size_--;
+        tombs_++;
+        return true;
+    }
+
+private:
+    size_t slot_of(const K& key) const noexcept {
+        if (capc_ == 0) return (size_t)-1;
+
+        size_t idx = Hash()(key) % capc_;
+        for (size_t i = 0; i < capc_; i++) {
+            size_t pos = (idx + i) % capc_;
+            if (used_[pos] == slot_none) return (size_t)-1;
+            if (used_[pos] == slot_full && Eq()(keys_[pos], key)) return pos;
+        }
+        return (size_t)-1;
+    }
+
+    static bool alloc_arrays(size_t capc, char** used, K** keys, V** values) noexcept {
+        *used   = (char*)Alloc::alloc(capc * sizeof(char));
+        *keys   = (K*)Alloc::alloc(capc * sizeof(K));
+        *values = (V*)Alloc::alloc(capc * sizeof(V));
+
+        if (!*used || !*keys || !*values) {
+            Alloc::free(*used);
+            Alloc::free(*keys);
+            Alloc::free(*values);
+            return false;
+        }
+
+        std::memset(*used, slot_none, capc * sizeof(char));
+        return true;
+    }
+
+    void destroy_entries() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<K> || !std::is_trivially_destructible_v<V>) {
+            for (size_t i = 0; i < capc_; i++) {
+                if (used_[i] != slot_full) continue;
+                keys_[i].~K();
+                values_[i].~V();
+            }
+        }
+    }
+
+    char*  used_   = nullptr;
+    K*     keys_   = nullptr;
+    V*     values_ = nullptr;
+    size_t size_   = 0; // actual count of items within
+    size_t tombs_  = 0; // count of tombstones, they lengthen probes as items do
+    size_t capc_   = 0; // size of arrays
+};
+
+} // namespace riff
+
+#pragma pop_macro("dyarr")
+#pragma pop_macro("queue")
+#pragma pop_macro("dlist")
+#pragma pop_macro("hhmap")
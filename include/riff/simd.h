@@ -0,0 +1,739 @@
+/*
+    T macro pattern
+        [instance name], [stored type], [kernel type - i32 | f32 | f64]
+
+    Vectorized search / filter kernels over plain buffers of primitive types, e.g. dyarr_access() ones
+    Kernel type must match stored type: i32 - 32 bit signed int, f32 - float, f64 - double
+    Requires dynamic_array.h to be included with the same instance name beforehand
+
+    On x86-64 kernels use SSE2 (always available) or AVX2 (selected at runtime, GCC / Clang only),
+    scalar code is used elsewhere. Results of every path are the same, except for floating point
+    sums (order of additions differs) and min / max of buffers containing NaNs (unspecified)
+    Kernels can be called from many threads at once, also for the first time (tables are constant,
+    the level is detected atomically)
+*/
+
+#include "generic.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Dispatch
+*/
+
+#ifndef RIFF_SIMD_DISPATCH
+#define RIFF_SIMD_DISPATCH
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define RIFF_SIMD_SSE2 1
+    #if defined(__GNUC__)
+        #define RIFF_SIMD_AVX2 1
+        #include <immintrin.h>
+    #else
+        #include <emmintrin.h>
+    #endif
+#endif
+
+#define RIFF_SIMD_LEVEL_SCALAR 0
+#define RIFF_SIMD_LEVEL_SSE2   1
+#define RIFF_SIMD_LEVEL_AVX2   2
+
+// currently used level, -1 until detected (per translation unit)
+// accessed atomically, threads making their first kernel calls at once may all detect it
+static int riff_simd_current_level = -1;
+
+#if defined(__GNUC__)
+    #define RIFF_SIMD_LOAD_LEVEL()       __atomic_load_n(&riff_simd_current_level, __ATOMIC_RELAXED)
+    #define RIFF_SIMD_STORE_LEVEL(level) __atomic_store_n(&riff_simd_current_level, (level), __ATOMIC_RELAXED)
+#else
+    #define RIFF_SIMD_LOAD_LEVEL()       (riff_simd_current_level)
+    #define RIFF_SIMD_STORE_LEVEL(level) (riff_simd_current_level = (level))
+#endif
+
+#if RIFF_SIMD_AVX2
+// compress-store permutations: indices of set bits of 8 bit mask (32 bit lanes)
+// and of 4 bit mask (64 bit lanes, as pairs of 32 bit indices)
+// constant, so no initialization can race between threads
+static const uint32_t riff_simd_lut_32[256][8] = {
+    { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 0, 0, 0, 0, 0, 0, 0 }, { 1, 0, 0, 0, 0, 0, 0, 0 }, { 0, 1, 0, 0, 0, 0, 0, 0 },
+    { 2, 0, 0, 0, 0, 0, 0, 0 }, { 0, 2, 0, 0, 0, 0, 0, 0 }, { 1, 2, 0, 0, 0, 0, 0, 0 }, { 0, 1, 2, 0, 0, 0, 0, 0 },
+    { 3, 0, 0, 0, 0, 0, 0, 0 }, { 0, 3, 0, 0, 0, 0, 0, 0 }, { 1, 3, 0, 0, 0, 0, 0, 0 }, { 0, 1, 3, 0, 0, 0, 0, 0 },
+    { 2, 3, 0, 0, 0, 0, 0, 0 }, { 0, 2, 3, 0, 0, 0, 0, 0 }, { 1, 2, 3, 0, 0, 0, 0, 0 }, { 0, 1, 2, 3, 0, 0, 0, 0 },
+    { 4, 0, 0, 0, 0, 0, 0, 0 }, { 0, 4, 0, 0, 0, 0, 0, 0 }, { 1, 4, 0, 0, 0, 0, 0, 0 }, { 0, 1, 4, 0, 0, 0, 0, 0 },
+    { 2, 4, 0, 0, 0, 0, 0, 0 }, { 0, 2, 4, 0, 0, 0, 0, 0 }, { 1, 2, 4, 0, 0, 0, 0, 0 }, { 0, 1, 2, 4, 0, 0, 0, 0 },
+    { 3, 4, 0, 0, 0, 0, 0, 0 }, { 0, 3, 4, 0, 0, 0, 0, 0 }, { 1, 3, 4, 0, 0, 0, 0, 0 }, { 0, 1, 3, 4, 0, 0, 0, 0 },
+    { 2, 3, 4, 0, 0, 0, 0, 0 }, { 0, 2, 3, 4, 0, 0, 0, 0 }, { 1, 2, 3, 4, 0, 0, 0, 0 }, { 0, 1, 2, 3, 4, 0, 0, 0 },
+    { 5, 0, 0, 0, 0, 0, 0, 0 }, { 0, 5, 0, 0, 0, 0, 0, 0 }, { 1, 5, 0, 0, 0, 0, 0, 0 }, { 0, 1, 5, 0, 0, 0, 0, 0 },
+    { 2, 5, 0, 0, 0, 0, 0, 0 }, { 0, 2, 5, 0, 0, 0, 0, 0 }, { 1, 2, 5, 0, 0, 0, 0, 0 }, { 0, 1, 2, 5, 0, 0, 0, 0 },
+    { 3, 5, 0, 0, 0, 0, 0, 0 }, { 0, 3, 5, 0, 0, 0, 0, 0 }, { 1, 3, 5, 0, 0, 0, 0, 0 }, { 0, 1, 3, 5, 0, 0, 0, 0 },
+    { 2, 3, 5, 0, 0, 0, 0, 0 }, { 0, 2, 3, 5, 0, 0, 0, 0 }, { 1, 2, 3, 5, 0, 0, 0, 0 }, { 0, 1, 2, 3, 5, 0, 0, 0 },
+    { 4, 5, 0, 0, 0, 0, 0, 0 }, { 0, 4, 5, 0, 0, 0, 0, 0 }, { 1, 4, 5, 0, 0, 0, 0, 0 }, { 0, 1, 4, 5, 0, 0, 0, 0 },
+    { 2, 4, 5, 0, 0, 0, 0, 0 }, { 0, 2, 4, 5, 0, 0, 0, 0 }, { 1, 2, 4, 5, 0, 0, 0, 0 }, { 0, 1, 2, 4, 5, 0, 0, 0 },
+    { 3, 4, 5, 0, 0, 0, 0, 0 }, { 0, 3, 4, 5, 0, 0, 0, 0 }, { 1, 3, 4, 5, 0, 0, 0, 0 }, { 0, 1, 3, 4, 5, 0, 0, 0 },
+    { 2, 3, 4, 5, 0, 0, 0, 0 }, { 0, 2, 3, 4, 5, 0, 0, 0 }, { 1, 2, 3, 4, 5, 0, 0, 0 }, { 0, 1, 2, 3, 4, 5, 0, 0 },
+    { 6, 0, 0, 0, 0, 0, 0, 0 }, { 0, 6, 0, 0, 0, 0, 0, 0 }, { 1, 6, 0, 0, 0, 0, 0, 0 }, { 0, 1, 6, 0, 0, 0, 0, 0 },
+    { 2, 6, 0, 0, 0, 0, 0, 0 }, { 0, 2, 6, 0, 0, 0, 0, 0 }, { 1, 2, 6, 0, 0, 0, 0, 0 }, { 0, 1, 2, 6, 0, 0, 0, 0 },
+    { 3, 6, 0, 0, 0, 0, 0, 0 }, { 0, 3, 6, 0, 0, 0, 0, 0 }, { 1, 3, 6, 0, 0, 0, 0, 0 }, { 0, 1, 3, 6, 0, 0, 0, 0 },
+    { 2, 3, 6, 0, 0, 0, 0, 0 }, { 0, 2, 3, 6, 0, 0, 0, 0 }, { 1, 2, 3, 6, 0, 0, 0, 0 }, { 0, 1, 2, 3, 6, 0, 0, 0 },
+    { 4, 6, 0, 0, 0, 0, 0, 0 }, { 0, 4, 6, 0, 0, 0, 0, 0 }, { 1, 4, 6, 0, 0, 0, 0, 0 }, { 0, 1, 4, 6, 0, 0, 0, 0 },
+    { 2, 4, 6, 0, 0, 0, 0, 0 }, { 0, 2, 4, 6, 0, 0, 0, 0 }, { 1, 2, 4, 6, 0, 0, 0, 0 }, { 0, 1, 2, 4, 6, 0, 0, 0 },
+    { 3, 4, 6, 0, 0, 0, 0, 0 }, { 0, 3, 4, 6, 0, 0, 0, 0 }, { 1, 3, 4, 6, 0, 0, 0, 0 }, { 0, 1, 3, 4, 6, 0, 0, 0 },
+    { 2, 3, 4, 6, 0, 0, 0, 0 }, { 0, 2, 3, 4, 6, 0, 0, 0 }, { 1, 2, 3, 4, 6, 0, 0, 0 }, { 0, 1, 2, 3, 4, 6, 0, 0 },
+    { 5, 6, 0, 0, 0, 0, 0, 0 }, { 0, 5, 6, 0, 0, 0, 0, 0 }, { 1, 5, 6, 0, 0, 0, 0, 0 }, { 0, 1, 5, 6, 0, 0, 0, 0 },
+    { 2, 5, 6, 0, 0, 0, 0, 0 }, { 0, 2, 5, 6, 0, 0, 0, 0 }, { 1, 2, 5, 6, 0, 0, 0, 0 }, { 0, 1, 2, 5, 6, 0, 0, 0 },
+    { 3, 5, 6, 0, 0, 0, 0, 0 }, { 0, 3, 5, 6, 0, 0, 0, 0 }, { 1, 3, 5, 6, 0, 0, 0, 0 }, { 0, 1, 3, 5, 6, 0, 0, 0 },
+    { 2, 3, 5, 6, 0, 0, 0, 0 }, { 0, 2, 3, 5, 6, 0, 0, 0 }, { 1, 2, 3, 5, 6, 0, 0, 0 }, { 0, 1, 2, 3, 5, 6, 0, 0 },
+    { 4, 5, 6, 0, 0, 0, 0, 0 }, { 0, 4, 5, 6, 0, 0, 0, 0 }, { 1, 4, 5, 6, 0, 0, 0, 0 }, { 0, 1, 4, 5, 6, 0, 0, 0 },
+    { 2, 4, 5, 6, 0, 0, 0, 0 }, { 0, 2, 4, 5, 6, 0, 0, 0 }, { 1, 2, 4, 5, 6, 0, 0, 0 }, { 0, 1, 2, 4, 5, 6, 0, 0 },
+    { 3, 4, 5, 6, 0, 0, 0, 0 }, { 0, 3, 4, 5, 6, 0, 0, 0 }, { 1, 3, 4, 5, 6, 0, 0, 0 }, { 0, 1, 3, 4, 5, 6, 0, 0 },
+    { 2, 3, 4, 5, 6, 0, 0, 0 }, { 0, 2, 3, 4, 5, 6, 0, 0 }, { 1, 2, 3, 4, 5, 6, 0, 0 }, { 0, 1, 2, 3, 4, 5, 6, 0 },
+    { 7, 0, 0, 0, 0, 0, 0, 0 }, { 0, 7, 0, 0, 0, 0, 0, 0 }, { 1, 7, 0, 0, 0, 0, 0, 0 }, { 0, 1, 7, 0, 0, 0, 0, 0 },
+    { 2, 7, 0, 0, 0, 0, 0, 0 }, { 0, 2, 7, 0, 0, 0, 0, 0 }, { 1, 2, 7, 0, 0, 0, 0, 0 }, { 0, 1, 2, 7, 0, 0, 0, 0 },
+    { 3, 7, 0, 0, 0, 0, 0, 0 }, { 0, 3, 7, 0, 0, 0, 0, 0 }, { 1, 3, 7, 0, 0, 0, 0, 0 }, { 0, 1, 3, 7, 0, 0, 0, 0 },
+    { 2, 3, 7, 0, 0, 0, 0, 0 }, { 0, 2, 3, 7, 0, 0, 0, 0 }, { 1, 2, 3, 7, 0, 0, 0, 0 }, { 0, 1, 2, 3, 7, 0, 0, 0 },
+    { 4, 7, 0, 0, 0, 0, 0, 0 }, { 0, 4, 7, 0, 0, 0, 0, 0 }, { 1, 4, 7, 0, 0, 0, 0, 0 }, { 0, 1, 4, 7, 0, 0, 0, 0 },
+    { 2, 4, 7, 0, 0, 0, 0, 0 }, { 0, 2, 4, 7, 0, 0, 0, 0 }, { 1, 2, 4, 7, 0, 0, 0, 0 }, { 0, 1, 2, 4, 7, 0, 0, 0 },
+    { 3, 4, 7, 0, 0, 0, 0, 0 }, { 0, 3, 4, 7, 0, 0, 0, 0 }, { 1, 3, 4, 7, 0, 0, 0, 0 }, { 0, 1, 3, 4, 7, 0, 0, 0 },
+    { 2, 3, 4, 7, 0, 0, 0, 0 }, { 0, 2, 3, 4, 7, 0, 0, 0 }, { 1, 2, 3, 4, 7, 0, 0, 0 }, { 0, 1, 2, 3, 4, 7, 0, 0 },
+    { 5, 7, 0, 0, 0, 0, 0, 0 }, { 0, 5, 7, 0, 0, 0, 0, 0 }, { 1, 5, 7, 0, 0, 0, 0, 0 }, { 0, 1, 5, 7, 0, 0, 0, 0 },
+    { 2, 5, 7, 0, 0, 0, 0, 0 }, { 0, 2, 5, 7, 0, 0, 0, 0 }, { 1, 2, 5, 7, 0, 0, 0, 0 }, { 0, 1, 2, 5, 7, 0, 0, 0 },
+    { 3, 5, 7, 0, 0, 0, 0, 0 }, { 0, 3, 5, 7, 0, 0, 0, 0 }, { 1, 3, 5, 7, 0, 0, 0, 0 }, { 0, 1, 3, 5, 7, 0, 0, 0 },
+    { 2, 3, 5, 7, 0, 0, 0, 0 }, { 0, 2, 3, 5, 7, 0, 0, 0 }, { 1, 2, 3, 5, 7, 0, 0, 0 }, { 0, 1, 2, 3, 5, 7, 0, 0 },
+    { 4, 5, 7, 0, 0, 0, 0, 0 }, { 0, 4, 5, 7, 0, 0, 0, 0 }, { 1, 4, 5, 7, 0, 0, 0, 0 }, { 0, 1, 4, 5, 7, 0, 0, 0 },
+    { 2, 4, 5, 7, 0, 0, 0, 0 }, { 0, 2, 4, 5, 7, 0, 0, 0 }, { 1, 2, 4, 5, 7, 0, 0, 0 }, { 0, 1, 2, 4, 5, 7, 0, 0 },
+    { 3, 4, 5, 7, 0, 0, 0, 0 }, { 0, 3, 4, 5, 7, 0, 0, 0 }, { 1, 3, 4, 5, 7, 0, 0, 0 }, { 0, 1, 3, 4, 5, 7, 0, 0 },
+    { 2, 3, 4, 5, 7, 0, 0, 0 }, { 0, 2, 3, 4, 5, 7, 0, 0 }, { 1, 2, 3, 4, 5, 7, 0, 0 }, { 0, 1, 2, 3, 4, 5, 7, 0 },
+    { 6, 7, 0, 0, 0, 0, 0, 0 }, { 0, 6, 7, 0, 0, 0, 0, 0 }, { 1, 6, 7, 0, 0, 0, 0, 0 }, { 0, 1, 6, 7, 0, 0, 0, 0 },
+    { 2, 6, 7, 0, 0, 0, 0, 0 }, { 0, 2, 6, 7, 0, 0, 0, 0 }, { 1, 2, 6, 7, 0, 0, 0, 0 }, { 0, 1, 2, 6, 7, 0, 0, 0 },
+    { 3, 6, 7, 0, 0, 0, 0, 0 }, { 0, 3, 6, 7, 0, 0, 0, 0 }, { 1, 3, 6, 7, 0, 0, 0, 0 }, { 0, 1, 3, 6, 7, 0, 0, 0 },
+    { 2, 3, 6, 7, 0, 0, 0, 0 }, { 0, 2, 3, 6, 7, 0, 0, 0 }, { 1, 2, 3, 6, 7, 0, 0, 0 }, { 0, 1, 2, 3, 6, 7, 0, 0 },
+    { 4, 6, 7, 0, 0, 0, 0, 0 }, { 0, 4, 6, 7, 0, 0, 0, 0 }, { 1, 4, 6, 7, 0, 0, 0, 0 }, { 0, 1, 4, 6, 7, 0, 0, 0 },
+    { 2, 4, 6, 7, 0, 0, 0, 0 }, { 0, 2, 4, 6, 7, 0, 0, 0 }, { 1, 2, 4, 6, 7, 0, 0, 0 }, { 0, 1, 2, 4, 6, 7, 0, 0 },
+    { 3, 4, 6, 7, 0, 0, 0, 0 }, { 0, 3, 4, 6, 7, 0, 0, 0 }, { 1, 3, 4, 6, 7, 0, 0, 0 }, { 0, 1, 3, 4, 6, 7, 0, 0 },
+    { 2, 3, 4, 6, 7, 0, 0, 0 }, { 0, 2, 3, 4, 6, 7, 0, 0 }, { 1, 2, 3, 4, 6, 7, 0, 0 }, { 0, 1, 2, 3, 4, 6, 7, 0 },
+    { 5, 6, 7, 0, 0, 0, 0, 0 }, { 0, 5, 6, 7, 0, 0, 0, 0 }, { 1, 5, 6, 7, 0, 0, 0, 0 }, { 0, 1, 5, 6, 7, 0, 0, 0 },
+    { 2, 5, 6, 7, 0, 0, 0, 0 }, { 0, 2, 5, 6, 7, 0, 0, 0 }, { 1, 2, 5, 6, 7, 0, 0, 0 }, { 0, 1, 2, 5, 6, 7, 0, 0 },
+    { 3, 5, 6, 7, 0, 0, 0, 0 }, { 0, 3, 5, 6, 7, 0, 0, 0 }, { 1, 3, 5, 6, 7, 0, 0, 0 }, { 0, 1, 3, 5, 6, 7, 0, 0 },
+    { 2, 3, 5, 6, 7, 0, 0, 0 }, { 0, 2, 3, 5, 6, 7, 0, 0 }, { 1, 2, 3, 5, 6, 7, 0, 0 }, { 0, 1, 2, 3, 5, 6, 7, 0 },
+    { 4, 5, 6, 7, 0, 0, 0, 0 }, { 0, 4, 5, 6, 7, 0, 0, 0 }, { 1, 4, 5, 6, 7, 0, 0, 0 }, { 0, 1, 4, 5, 6, 7, 0, 0 },
+    { 2, 4, 5, 6, 7, 0, 0, 0 }, { 0, 2, 4, 5, 6, 7, 0, 0 }, { 1, 2, 4, 5, 6, 7, 0, 0 }, { 0, 1, 2, 4, 5, 6, 7, 0 },
+    { 3, 4, 5, 6, 7, 0, 0, 0 }, { 0, 3, 4, 5, 6, 7, 0, 0 }, { 1, 3, 4, 5, 6, 7, 0, 0 }, { 0, 1, 3, 4, 5, 6, 7, 0 },
+    { 2, 3, 4, 5, 6, 7, 0, 0 }, { 0, 2, 3, 4, 5, 6, 7, 0 }, { 1, 2, 3, 4, 5, 6, 7, 0 }, { 0, 1, 2, 3, 4, 5, 6, 7 },
+};
+
+static const uint32_t riff_simd_lut_64[16][8] = {
+    { 0, 0, 0, 0, 0, 0, 0, 0 }, { 0, 1, 0, 0, 0, 0, 0, 0 }, { 2, 3, 0, 0, 0, 0, 0, 0 }, { 0, 1, 2, 3, 0, 0, 0, 0 },
+    { 4, 5, 0, 0, 0, 0, 0, 0 }, { 0, 1, 4, 5, 0, 0, 0, 0 }, { 2, 3, 4, 5, 0, 0, 0, 0 }, { 0, 1, 2, 3, 4, 5, 0, 0 },
+    { 6, 7, 0, 0, 0, 0, 0, 0 }, { 0, 1, 6, 7, 0, 0, 0, 0 }, { 2, 3, 6, 7, 0, 0, 0, 0 }, { 0, 1, 2, 3, 6, 7, 0, 0 },
+    { 4, 5, 6, 7, 0, 0, 0, 0 }, { 0, 1, 4, 5, 6, 7, 0, 0 }, { 2, 3, 4, 5, 6, 7, 0, 0 }, { 0, 1, 2, 3, 4, 5, 6, 7 },
+};
+#endif
+
+// Returns best kernel level supported by the machine
+// O(1)
+RIFF_API(int) riff_simd_supported_level(void) {
+#if RIFF_SIMD_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return RIFF_SIMD_LEVEL_AVX2;
+#endif
+#if RIFF_SIMD_SSE2
+    return RIFF_SIMD_LEVEL_SSE2;
+#else
+    return RIFF_SIMD_LEVEL_SCALAR;
+#endif
+}
+
+// Forces kernels to given level (e.g. for benchmarking), clamped to the supported one
+// Affects calls from the current translation unit only, calls already running in other threads
+// finish on the level they started with
+RIFF_API(void) riff_simd_set_level(int level) {
+    int supported = riff_simd_supported_level();
+    RIFF_SIMD_STORE_LEVEL(level < supported ? level : supported);
+}
+
+// Returns level used by kernels, detects it at first call
+// Thread safe, concurrent first calls detect the same level
+// O(1)
+RIFF_API(int) riff_simd_level(void) {
+    int level = RIFF_SIMD_LOAD_LEVEL();
+    if (level < 0) {
+        riff_simd_set_level(RIFF_SIMD_LEVEL_AVX2);
+        level = RIFF_SIMD_LOAD_LEVEL();
+    }
+    return level;
+}
+
+RIFF_API(unsigned) riff_simd_internal_ctz(unsigned m) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctz(m);
+#else
+    unsigned n = 0;
+    while (!(m & 1u)) { m >>= 1; n++; }
+    return n;
+#endif
+}
+
+RIFF_API(unsigned) riff_simd_internal_popcount(unsigned m) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_popcount(m);
+#else
+    unsigned n = 0;
+    for (; m; m &= m - 1) n++;
+    return n;
+#endif
+}
+
+#if RIFF_SIMD_SSE2
+// SSE2 lacks 32 bit integer min / max and sign extension
+RIFF_API(__m128i) riff_simd_internal_min_epi32(__m128i a, __m128i b) {
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+
+RIFF_API(__m128i) riff_simd_internal_max_epi32(__m128i a, __m128i b) {
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+RIFF_API(__m128i) riff_simd_internal_add_widen_sse2(__m128i acc, __m128i x) {
+    __m128i sign = _mm_srai_epi32(x, 31);
+    acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(x, sign));
+    return _mm_add_epi64(acc, _mm_unpackhi_epi32(x, sign));
+}
+#endif
+
+#if RIFF_SIMD_AVX2
+__attribute__((target("avx2")))
+RIFF_API(__m256i) riff_simd_internal_add_widen_avx2(__m256i acc, __m256i x) {
+    acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+    return _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+}
+#endif
+
+#define RIFF_SIMD_KIND_i32 1
+#define RIFF_SIMD_KIND_f32 2
+#define RIFF_SIMD_KIND_f64 3
+
+#endif // RIFF_SIMD_DISPATCH
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE RIFF_FIRST(T)
+#define STORED   RIFF_SECOND(T)
+#define KIND     RIFF_CAT(RIFF_SIMD_KIND_, RIFF_THIRD(T))
+
+// per kernel type vector operations, X_ - SSE2, Y_ - AVX2
+#if KIND == RIFF_SIMD_KIND_i32
+    #define SUM_T int64_t
+
+    #define X_W                     4
+    #define X_VEC                   __m128i
+    #define X_LOAD(p)               _mm_loadu_si128((const __m128i*)(p))
+    #define X_STORE(p, v)           _mm_storeu_si128((__m128i*)(p), v)
+    #define X_SET1(v)               _mm_set1_epi32(v)
+    #define X_MASK_EQ(a, b)         _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)))
+    #define X_MASK_RANGE(x, lo, hi) (_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_cmplt_epi32(x, lo), _mm_cmpgt_epi32(x, hi)))) ^ 0xF)
+    #define X_MIN(a, b)             riff_simd_internal_min_epi32(a, b)
+    #define X_MAX(a, b)             riff_simd_internal_max_epi32(a, b)
+    #define X_ACC                   __m128i
+    #define X_ACC_ZERO              _mm_setzero_si128()
+    #define X_ACC_ADD(acc, v)       riff_simd_internal_add_widen_sse2(acc, v)
+    #define X_ACC_LANES             2
+    #define X_ACC_STORE(p, acc)     _mm_storeu_si128((__m128i*)(p), acc)
+    #define X_EQ_BITS(a, b)         _mm_cmpeq_epi32(a, b)
+    #define X_CNT_SUB(c, bits)      _mm_sub_epi32(c, bits)
+    #define X_CNT_T                 uint32_t
+    #define X_CNT_LANES             4
+
+    #define Y_W                     8
+    #define Y_VEC                   __m256i
+    #define Y_LOAD(p)               _mm256_loadu_si256((const __m256i*)(p))
+    #define Y_STORE(p, v)           _mm256_storeu_si256((__m256i*)(p), v)
+    #define Y_SET1(v)               _mm256_set1_epi32(v)
+    #define Y_MASK_EQ(a, b)         _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)))
+    #define Y_MASK_RANGE(x, lo, hi) (_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpgt_epi32(lo, x), _mm256_cmpgt_epi32(x, hi)))) ^ 0xFF)
+    #define Y_MIN(a, b)             _mm256_min_epi32(a, b)
+    #define Y_MAX(a, b)             _mm256_max_epi32(a, b)
+    #define Y_COMPRESS(x, m)        _mm256_permutevar8x32_epi32(x, _mm256_loadu_si256((const __m256i*)riff_simd_lut_32[m]))
+    #define Y_ACC                   __m256i
+    #define Y_ACC_ZERO              _mm256_setzero_si256()
+    #define Y_ACC_ADD(acc, v)       riff_simd_internal_add_widen_avx2(acc, v)
+    #define Y_ACC_LANES             4
+    #define Y_ACC_STORE(p, acc)     _mm256_storeu_si256((__m256i*)(p), acc)
+    #define Y_EQ_BITS(a, b)         _mm256_cmpeq_epi32(a, b)
+    #define Y_CNT_SUB(c, bits)      _mm256_sub_epi32(c, bits)
+    #define Y_CNT_T                 uint32_t
+    #define Y_CNT_LANES             8
+#elif KIND == RIFF_SIMD_KIND_f32
+    #define SUM_T float
+
+    #define X_W                     4
+    #define X_VEC                   __m128
+    #define X_LOAD(p)               _mm_loadu_ps(p)
+    #define X_STORE(p, v)           _mm_storeu_ps(p, v)
+    #define X_SET1(v)               _mm_set1_ps(v)
+    #define X_MASK_EQ(a, b)         _mm_movemask_ps(_mm_cmpeq_ps(a, b))
+    #define X_MASK_RANGE(x, lo, hi) _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(x, lo), _mm_cmple_ps(x, hi)))
+    #define X_MIN(a, b)             _mm_min_ps(a, b)
+    #define X_MAX(a, b)             _mm_max_ps(a, b)
+    #define X_ACC                   __m128
+    #define X_ACC_ZERO              _mm_setzero_ps()
+    #define X_ACC_ADD(acc, v)       _mm_add_ps(acc, v)
+    #define X_ACC_LANES             4
+    #define X_ACC_STORE(p, acc)     _mm_storeu_ps(p, acc)
+    #define X_EQ_BITS(a, b)         _mm_castps_si128(_mm_cmpeq_ps(a, b))
+    #define X_CNT_SUB(c, bits)      _mm_sub_epi32(c, bits)
+    #define X_CNT_T                 uint32_t
+    #define X_CNT_LANES             4
+
+    #define Y_W                     8
+    #define Y_VEC                   __m256
+    #define Y_LOAD(p)               _mm256_loadu_ps(p)
+    #define Y_STORE(p, v)           _mm256_storeu_ps(p, v)
+    #define Y_SET1(v)               _mm256_set1_ps(v)
+    #define Y_MASK_EQ(a, b)         _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))
+    #define Y_MASK_RANGE(x, lo, hi) _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(x, lo, _CMP_GE_OQ), _mm256_cmp_ps(x, hi, _CMP_LE_OQ)))
+    #define Y_MIN(a, b)             _mm256_min_ps(a, b)
+    #define Y_MAX(a, b)             _mm256_max_ps(a, b)
+    #define Y_COMPRESS(x, m)        _mm256_permutevar8x32_ps(x, _mm256_loadu_si256((const __m256i*)riff_simd_lut_32[m]))
+    #define Y_ACC                   __m256
+    #define Y_ACC_ZERO              _mm256_setzero_ps()
+    #define Y_ACC_ADD(acc, v)       _mm256_add_ps(acc, v)
+    #define Y_ACC_LANES             8
+    #define Y_ACC_STORE(p, acc)     _mm256_storeu_ps(p, acc)
+    #define Y_EQ_BITS(a, b)         _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))
+    #define Y_CNT_SUB(c, bits)      _mm256_sub_epi32(c, bits)
+    #define Y_CNT_T                 uint32_t
+    #define Y_CNT_LANES             8
+#elif KIND == RIFF_SIMD_KIND_f64
+    #define SUM_T double
+
+    #define X_W                     2
+    #define X_VEC                   __m128d
+    #define X_LOAD(p)               _mm_loadu_pd(p)
+    #define X_STORE(p, v)           _mm_storeu_pd(p, v)
+    #define X_SET1(v)               _mm_set1_pd(v)
+    #define X_MASK_EQ(a, b)         _mm_movemask_pd(_mm_cmpeq_pd(a, b))
+    #define X_MASK_RANGE(x, lo, hi) _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(x, lo), _mm_cmple_pd(x, hi)))
+    #define X_MIN(a, b)             _mm_min_pd(a, b)
+    #define X_MAX(a, b)             _mm_max_pd(a, b)
+    #define X_ACC                   __m128d
+    #define X_ACC_ZERO              _mm_setzero_pd()
+    #define X_ACC_ADD(acc, v)       _mm_add_pd(acc, v)
+    #define X_ACC_LANES             2
+    #define X_ACC_STORE(p, acc)     _mm_storeu_pd(p, acc)
+    #define X_EQ_BITS(a, b)         _mm_castpd_si128(_mm_cmpeq_pd(a, b))
+    #define X_CNT_SUB(c, bits)      _mm_sub_epi64(c, bits)
+    #define X_CNT_T                 uint64_t
+    #define X_CNT_LANES             2
+
+    #define Y_W                     4
+    #define Y_VEC                   __m256d
+    #define Y_LOAD(p)               _mm256_loadu_pd(p)
+    #define Y_STORE(p, v)           _mm256_storeu_pd(p, v)
+    #define Y_SET1(v)               _mm256_set1_pd(v)
+    #define Y_MASK_EQ(a, b)         _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))
+    #define Y_MASK_RANGE(x, lo, hi) _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(x, lo, _CMP_GE_OQ), _mm256_cmp_pd(x, hi, _CMP_LE_OQ)))
+    #define Y_MIN(a, b)             _mm256_min_pd(a, b)
+    #define Y_MAX(a, b)             _mm256_max_pd(a, b)
+    #define Y_COMPRESS(x, m)        _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(x), _mm256_loadu_si256((const __m256i*)riff_simd_lut_64[m])))
+    #define Y_ACC                   __m256d
+    #define Y_ACC_ZERO              _mm256_setzero_pd()
+    #define Y_ACC_ADD(acc, v)       _mm256_add_pd(acc, v)
+    #define Y_ACC_LANES             4
+    #define Y_ACC_STORE(p, acc)     _mm256_storeu_pd(p, acc)
+    #define Y_EQ_BITS(a, b)         _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))
+    #define Y_CNT_SUB(c, bits)      _mm256_sub_epi64(c, bits)
+    #define Y_CNT_T                 uint64_t
+    #define Y_CNT_LANES             4
+#else
+    #error Unsupported kernel type in "T" macro, expected i32, f32 or f64.
+#endif
+
+#define AVX2_FUNC __attribute__((target("avx2")))
+
+// 32 bit lane counters are flushed before they could overflow
+#define COUNT_BLOCK ((size_t)1 << 30)
+
+/*
+    Scalar Kernels
+*/
+
+RIFF_API(size_t) RIFF_INST(simd_internal_find_scalar, INSTANCE)(const STORED* data, size_t size, STORED value) {
+    size_t i = 0;
+    while (i < size && !(data[i] == value)) i++;
+    return i;
+}
+
+RIFF_API(size_t) RIFF_INST(simd_internal_count_scalar, INSTANCE)(const STORED* data, size_t size, STORED value) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; i++) count += data[i] == value;
+    return count;
+}
+
+RIFF_API(STORED) RIFF_INST(simd_internal_min_scalar, INSTANCE)(const STORED* data, size_t size) {
+    STORED m = data[0];
+    for (size_t i = 1; i < size; i++) if (data[i] < m) m = data[i];
+    return m;
+}
+
+RIFF_API(STORED) RIFF_INST(simd_internal_max_scalar, INSTANCE)(const STORED* data, size_t size) {
+    STORED m = data[0];
+    for (size_t i = 1; i < size; i++) if (data[i] > m) m = data[i];
+    return m;
+}
+
+RIFF_API(SUM_T) RIFF_INST(simd_internal_sum_scalar, INSTANCE)(const STORED* data, size_t size) {
+    SUM_T sum = 0;
+    for (size_t i = 0; i < size; i++) sum += (SUM_T)data[i];
+    return sum;
+}
+
+RIFF_API(size_t) RIFF_INST(simd_internal_filter_scalar, INSTANCE)(const STORED* data, size_t size, STORED lo, STORED hi, STORED* out) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; i++) {
+        out[count] = data[i];
+        count += (data[i] >= lo) & (data[i] <= hi);
+    }
+    return count;
+}
+
+/*
+    SSE2 Kernels
+*/
+
+#if RIFF_SIMD_SSE2
+
+RIFF_API(size_t) RIFF_INST(simd_internal_find_sse2, INSTANCE)(const STORED* data, size_t size, STORED value) {
+    X_VEC  v = X_SET1(value);
+    size_t i = 0;
+    for (; i + X_W <= size; i += X_W) {
+        unsigned m = (unsigned)X_MASK_EQ(X_LOAD(data + i), v);
+        if (m) return i + riff_simd_internal_ctz(m);
+    }
+    return i + RIFF_INST(simd_internal_find_scalar, INSTANCE)(data + i, size - i, value);
+}
+
+RIFF_API(size_t) RIFF_INST(simd_internal_count_sse2, INSTANCE)(const STORED* data, size_t size, STORED value) {
+    X_VEC  v = X_SET1(value);
+    size_t count = 0;
+    size_t i = 0;
+    while (i + X_W <= size) {
+        // matches are all ones (-1) lanes, subtracting them counts per lane
+        __m128i lane_counts = _mm_setzero_si128();
+        size_t  block_end   = size - i > COUNT_BLOCK ? i + COUNT_BLOCK : size;
+        for (; i + X_W <= block_end; i += X_W) lane_counts = X_CNT_SUB(lane_counts, X_EQ_BITS(X_LOAD(data + i), v));
+
+        X_CNT_T lanes[X_CNT_LANES];
+        memcpy(lanes, &lane_counts, sizeof(lanes));
+        for (int l = 0; l < X_CNT_LANES; l++) count += (size_t)lanes[l];
+    }
+    return count + RIFF_INST(simd_internal_count_scalar, INSTANCE)(data + i, size - i, value);
+}
+
+RIFF_API(STORED) RIFF_INST(simd_internal_min_sse2, INSTANCE)(const STORED* data, size_t size) {
+    if (size < X_W) return RIFF_INST(simd_internal_min_scalar, INSTANCE)(data, size);
+
+    X_VEC  acc = X_LOAD(data);
+    size_t i = X_W;
+    for (; i + X_W <= size; i += X_W) acc = X_MIN(X_LOAD(data + i), acc);
+
+    STORED lanes[X_W];
+    X_STORE(lanes, acc);
+    STORED m = RIFF_INST(simd_internal_min_scalar, INSTANCE)(lanes, X_W);
+    for (; i < size; i++) if (data[i] < m) m = data[i];
+    return m;
+}
+
+RIFF_API(STORED) RIFF_INST(simd_internal_max_sse2, INSTANCE)(const STORED* data, size_t size) {
+    if (size < X_W) return RIFF_INST(simd_internal_max_scalar, INSTANCE)(data, size);
+
+    X_VEC  acc = X_LOAD(data);
+    size_t i = X_W;
+    for (; i + X_W <= size; i += X_W) acc = X_MAX(X_LOAD(data + i), acc);
+
+    STORED lanes[X_W];
+    X_STORE(lanes, acc);
+    STORED m = RIFF_INST(simd_internal_max_scalar, INSTANCE)(lanes, X_W);
+    for (; i < size; i++) if (data[i] > m) m = data[i];
+    return m;
+}
+
+RIFF_API(SUM_T) RIFF_INST(simd_internal_sum_sse2, INSTANCE)(const STORED* data, size_t size) {
+    X_ACC  acc = X_ACC_ZERO;
+    size_t i = 0;
+    for (; i + X_W <= size; i += X_W) acc = X_ACC_ADD(acc, X_LOAD(data + i));
+
+    SUM_T lanes[X_ACC_LANES];
+    X_ACC_STORE(lanes, acc);
+    SUM_T sum = 0;
+    for (int l = 0; l < X_ACC_LANES; l++) sum += lanes[l];
+    return sum + RIFF_INST(simd_internal_sum_scalar, INSTANCE)(data + i, size - i);
+}
+
+RIFF_API(size_t) RIFF_INST(simd_internal_filter_sse2, INSTANCE)(const STORED* data, size_t size, STORED lo, STORED hi, STORED* out) {
+    X_VEC  vlo = X_SET1(lo);
+    X_VEC  vhi = X_SET1(hi);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + X_W <= size; i += X_W) {
+        // no shuffle by mask in SSE2, store every lane and advance only past matches
+        unsigned m = (unsigned)X_MASK_RANGE(X_LOAD(data + i), vlo, vhi);
+        for (int l = 0; l < X_W; l++) {
+            out[count] = data[i + l];
+            count += (m >> l) & 1;
+        }
+    }
+    return count + RIFF_INST(simd_internal_filter_scalar, INSTANCE)(data + i, size - i, lo, hi, out + count);
+}
+
+#endif
+
+/*
+    AVX2 Kernels
+*/
+
+#if RIFF_SIMD_AVX2
+
+AVX2_FUNC
+RIFF_API(size_t) RIFF_INST(simd_internal_find_avx2, INSTANCE)(const STORED* data, size_t size, STORED value) {
+    Y_VEC  v = Y_SET1(value);
+    size_t i = 0;
+    for (; i + Y_W <= size; i += Y_W) {
+        unsigned m = (unsigned)Y_MASK_EQ(Y_LOAD(data + i), v);
+        if (m) return i + riff_simd_internal_ctz(m);
+    }
+    return i + RIFF_INST(simd_internal_find_scalar, INSTANCE)(data + i, size - i, value);
+}
+
+AVX2_FUNC
+RIFF_API(size_t) RIFF_INST(simd_internal_count_avx2, INSTANCE)(const STORED* data, size_t size, STORED value) {
+    Y_VEC  v = Y_SET1(value);
+    size_t count = 0;
+    size_t i = 0;
+    while (i + Y_W <= size) {
+        // matches are all ones (-1) lanes, subtracting them counts per lane
+        __m256i lane_counts = _mm256_setzero_si256();
+        size_t  block_end   = size - i > COUNT_BLOCK ? i + COUNT_BLOCK : size;
+        for (; i + Y_W <= block_end; i += Y_W) lane_counts = Y_CNT_SUB(lane_counts, Y_EQ_BITS(Y_LOAD(data + i), v));
+
+        Y_CNT_T lanes[Y_CNT_LANES];
+        memcpy(lanes, &lane_counts, sizeof(lanes));
+        for (int l = 0; l < Y_CNT_LANES; l++) count += (size_t)lanes[l];
+    }
+    return count + RIFF_INST(simd_internal_count_scalar, INSTANCE)(data + i, size - i, value);
+}
+
+AVX2_FUNC
+RIFF_API(STORED) RIFF_INST(simd_internal_min_avx2, INSTANCE)(const STORED* data, size_t size) {
+    if (size < Y_W) return RIFF_INST(simd_internal_min_scalar, INSTANCE)(data, size);
+
+    Y_VEC  acc = Y_LOAD(data);
+    size_t i = Y_W;
+    for (; i + Y_W <= size; i += Y_W) acc = Y_MIN(Y_LOAD(data + i), acc);
+
+    STORED lanes[Y_W];
+    Y_STORE(lanes, acc);
+    STORED m = RIFF_INST(simd_internal_min_scalar, INSTANCE)(lanes, Y_W);
+    for (; i < size; i++) if (data[i] < m) m = data[i];
+    return m;
+}
+
+AVX2_FUNC
+RIFF_API(STORED) RIFF_INST(simd_internal_max_avx2, INSTANCE)(const STORED* data, size_t size) {
+    if (size < Y_W) return RIFF_INST(simd_internal_max_scalar, INSTANCE)(data, size);
+
+    Y_VEC  acc = Y_LOAD(data);
+    size_t i = Y_W;
+    for (; i + Y_W <= size; i += Y_W) acc = Y_MAX(Y_LOAD(data + i), acc);
+
+    STORED lanes[Y_W];
+    Y_STORE(lanes, acc);
+    STORED m = RIFF_INST(simd_internal_max_scalar, INSTANCE)(lanes, Y_W);
+    for (; i < size; i++) if (data[i] > m) m = data[i];
+    return m;
+}
+
+AVX2_FUNC
+RIFF_API(SUM_T) RIFF_INST(simd_internal_sum_avx2, INSTANCE)(const STORED* data, size_t size) {
+    Y_ACC  acc = Y_ACC_ZERO;
+    size_t i = 0;
+    for (; i + Y_W <= size; i += Y_W) acc = Y_ACC_ADD(acc, Y_LOAD(data + i));
+
+    SUM_T lanes[Y_ACC_LANES];
+    Y_ACC_STORE(lanes, acc);
+    SUM_T sum = 0;
+    for (int l = 0; l < Y_ACC_LANES; l++) sum += lanes[l];
+    return sum + RIFF_INST(simd_internal_sum_scalar, INSTANCE)(data + i, size - i);
+}
+
+AVX2_FUNC
+RIFF_API(size_t) RIFF_INST(simd_internal_filter_avx2, INSTANCE)(const STORED* data, size_t size, STORED lo, STORED hi, STORED* out) {
+    Y_VEC  vlo = Y_SET1(lo);
+    Y_VEC  vhi = Y_SET1(hi);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + Y_W <= size; i += Y_W) {
+        // move matching lanes to the front and store whole vector, count <= i so it stays within out
+        Y_VEC    x = Y_LOAD(data + i);
+        unsigned m = (unsigned)Y_MASK_RANGE(x, vlo, vhi);
+        Y_STORE(out + count, Y_COMPRESS(x, m));
+        count += riff_simd_internal_popcount(m);
+    }
+    return count + RIFF_INST(simd_internal_filter_scalar, INSTANCE)(data + i, size - i, lo, hi, out + count);
+}
+
+#endif
+
+// picks kernel for current level
+#if RIFF_SIMD_AVX2
+    #define DISPATCH(kernel, ...) \
+        (riff_simd_level() == RIFF_SIMD_LEVEL_AVX2 ? RIFF_INST(RIFF_CAT(kernel, _avx2), INSTANCE)(__VA_ARGS__) : \
+         riff_simd_level() == RIFF_SIMD_LEVEL_SSE2 ? RIFF_INST(RIFF_CAT(kernel, _sse2), INSTANCE)(__VA_ARGS__) : \
+                                                     RIFF_INST(RIFF_CAT(kernel, _scalar), INSTANCE)(__VA_ARGS__))
+#elif RIFF_SIMD_SSE2
+    #define DISPATCH(kernel, ...) \
+        (riff_simd_level() == RIFF_SIMD_LEVEL_SSE2 ? RIFF_INST(RIFF_CAT(kernel, _sse2), INSTANCE)(__VA_ARGS__) : \
+                                                     RIFF_INST(RIFF_CAT(kernel, _scalar), INSTANCE)(__VA_ARGS__))
+#else
+    #define DISPATCH(kernel, ...) RIFF_INST(RIFF_CAT(kernel, _scalar), INSTANCE)(__VA_ARGS__)
+#endif
+
+/*
+    Operations
+*/
+
+// Searches buffer for the first element equal to value
+// If succeeded and index is not NULL, sets *index to its position
+// May fail (no such element), O(n)
+#define simd_find(inst) RIFF_INST(simd_find, inst)
+
+RIFF_API(int) simd_find(INSTANCE)(const STORED* data, size_t size, STORED value, size_t* index) {
+    size_t pos = DISPATCH(simd_internal_find, data, size, value);
+    if (pos == size) return ERR;
+
+    if (index) *index = pos;
+    return SCC;
+}
+
+// Returns whether buffer contains element equal to value
+// O(n)
+#define simd_contains(inst) RIFF_INST(simd_contains, inst)
+
+RIFF_API(int) simd_contains(INSTANCE)(const STORED* data, size_t size, STORED value) {
+    return DISPATCH(simd_internal_find, data, size, value) != size;
+}
+
+// Returns count of elements equal to value
+// O(n)
+#define simd_count(inst) RIFF_INST(simd_count, inst)
+
+RIFF_API(size_t) simd_count(INSTANCE)(const STORED* data, size_t size, STORED value) {
+    return DISPATCH(simd_internal_count, data, size, value);
+}
+
+// Sets *out to the smallest element of the buffer
+// May fail (empty buffer), O(n)
+#define simd_min(inst) RIFF_INST(simd_min, inst)
+
+RIFF_API(int) simd_min(INSTANCE)(const STORED* data, size_t size, STORED* out) {
+    if (size == 0) return ERR;
+    *out = DISPATCH(simd_internal_min, data, size);
+    return SCC;
+}
+
+// Sets *out to the greatest element of the buffer
+// May fail (empty buffer), O(n)
+#define simd_max(inst) RIFF_INST(simd_max, inst)
+
+RIFF_API(int) simd_max(INSTANCE)(const STORED* data, size_t size, STORED* out) {
+    if (size == 0) return ERR;
+    *out = DISPATCH(simd_internal_max, data, size);
+    return SCC;
+}
+
+// Returns sum of all elements, i32 elements are summed as int64_t, so it does not overflow
+// O(n)
+#define simd_sum(inst) RIFF_INST(simd_sum, inst)
+
+RIFF_API(SUM_T) simd_sum(INSTANCE)(const STORED* data, size_t size) {
+    return DISPATCH(simd_internal_sum, data, size);
+}
+
+// Appends elements within [lo, hi] range to out, preserving their order (compress-store)
+// Reserves capacity for all size elements in out, shrink out afterwards if needed
+// May fail (allocation), out is left unchanged then, O(n)
+#define simd_filter_range(inst) RIFF_INST(simd_filter_range, inst)
+
+RIFF_API(int) simd_filter_range(INSTANCE)(const STORED* data, size_t size, STORED lo, STORED hi, dyarr(INSTANCE)* out) {
+    size_t old_size = dyarr_size(INSTANCE)(out);
+    if (dyarr_reserve(INSTANCE)(out, old_size + size) == ERR) return ERR;
+
+    STORED* tail  = dyarr_access(INSTANCE)(out) + old_size;
+    size_t  count = DISPATCH(simd_internal_filter, data, size, lo, hi, tail);
+
+    dyarr_extend(INSTANCE)(out, count); // capacity already reserved, cannot fail
+    return SCC;
+}
+
+#undef DISPATCH
+#undef AVX2_FUNC
+#undef COUNT_BLOCK
+
+#undef SUM_T
+#undef X_W
+#undef X_VEC
+#undef X_LOAD
+#undef X_STORE
+#undef X_SET1
+#undef X_MASK_EQ
+#undef X_MASK_RANGE
+#undef X_MIN
+#undef X_MAX
+#undef X_ACC
+#undef X_ACC_ZERO
+#undef X_ACC_ADD
+#undef X_ACC_LANES
+#undef X_ACC_STORE
+#undef X_EQ_BITS
+#undef X_CNT_SUB
+#undef X_CNT_T
+#undef X_CNT_LANES
+#undef Y_W
+#undef Y_VEC
+#undef Y_LOAD
+#undef Y_STORE
+#undef Y_SET1
+#undef Y_MASK_EQ
+#undef Y_MASK_RANGE
+#undef Y_MIN
+#undef Y_MAX
+#undef Y_COMPRESS
+#undef Y_ACC
+#undef Y_ACC_ZERO
+#undef Y_ACC_ADD
+#undef Y_ACC_LANES
+#undef Y_ACC_STORE
+#undef Y_EQ_BITS
+#undef Y_CNT_SUB
+#undef Y_CNT_T
+#undef Y_CNT_LANES
+
+#undef INSTANCE
+#undef STORED
+#undef KIND
+
+// consume parameters
+#undef T
+#undef A
@@ -0,0 +1,308 @@
+/*
+    T macro pattern
+        [instance name], [stored type], [stored type destructor (opt)]
+
+    Elements live densely packed in one array, so iteration is a plain loop over slotmap_access()
+    Every element gets a handle on insertion, valid until the element is erased, regardless of
+    other insertions and erasures. Handles of erased elements are detected as stale (generation check)
+    Erasure moves the last element into the hole - dense order is not insertion order
+*/
+
+#include "generic.h"
+
+#include <stdint.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Handles
+*/
+
+#ifndef RIFF_SLOTMAP_HANDLE
+#define RIFF_SLOTMAP_HANDLE
+
+// Slot map handle, shared by all instances
+// Zero-initialized handle is never valid, so it can serve as a null handle
+typedef struct riff_slotmap_handle {
+    uint32_t index;      // slot
+    uint32_t generation; // generation of the slot at insertion
+} riff_slotmap_handle;
+
+// slot of the indirection array
+typedef struct riff_slotmap_slot {
+    uint32_t index;      // dense position if occupied, next free slot + 1 (0 for none) if free
+    uint32_t generation; // bumped on every erasure, never 0
+} riff_slotmap_slot;
+
+#endif // RIFF_SLOTMAP_HANDLE
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE   RIFF_FIRST(T)
+#define STORED     RIFF_SECOND(T)
+#define DESTRUCTOR RIFF_THIRD(T)
+#define TRIVIAL    RIFF_IS_EMPTY(DESTRUCTOR)
+
+#if TRIVIAL
+    #define DESTROY(ptr)
+#else
+    #define DESTROY(ptr) DESTRUCTOR(ptr)
+#endif
+
+#define MAX_SIZE ((size_t)UINT32_MAX)
+
+/*
+    Typedef
+*/
+
+// Slot Map (slotmap)
+// Dense element storage, indirection array of generation counted slots and a free list of slots
+// O(1) insert, erase and access by handle, iteration as fast as of an array
+// O(n) memory complexity
+#define slotmap(inst) RIFF_INST(slotmap, inst)
+
+typedef struct slotmap(INSTANCE) {
+    size_t             priv_size;
+    size_t             priv_capc;
+    STORED*            priv_data;       // dense elements
+    uint32_t*          priv_slot_of;    // dense position -> slot
+    riff_slotmap_slot* priv_slots;      // slot -> dense position
+    size_t             priv_slots_used; // slots ever handed out, never more than capacity
+    uint32_t           priv_free;       // first free slot + 1, 0 if none
+} slotmap(INSTANCE);
+
+/*
+    Zero / Destruction
+*/
+
+// Makes unitialized memory proper 0-initialized empty slot map
+// Does not free anything
+#define slotmap_zero(inst) RIFF_INST(slotmap_zero, inst)
+
+RIFF_API(void) slotmap_zero(INSTANCE)(slotmap(INSTANCE)* tar) {
+    tar->priv_size       = 0;
+    tar->priv_capc       = 0;
+    tar->priv_data       = NULL;
+    tar->priv_slot_of    = NULL;
+    tar->priv_slots      = NULL;
+    tar->priv_slots_used = 0;
+    tar->priv_free       = 0;
+}
+
+// Properly destroys given slot map, all handles become stale
+// Handles taken before destruction must not be used with the map anymore
+// (the generations are lost, so they could be valid again)
+// O(n) if destructor definied, O(1) otherwise
+#define slotmap_destroy(inst) RIFF_INST(slotmap_destroy, inst)
+
+RIFF_API(void) slotmap_destroy(INSTANCE)(slotmap(INSTANCE)* tar) {
+#if !TRIVIAL
+    for (size_t i = 0; i < tar->priv_size; i++) DESTRUCTOR(&tar->priv_data[i]);
+#endif
+    RIFF_FREE(tar->priv_data);
+    RIFF_FREE(tar->priv_slot_of);
+    RIFF_FREE(tar->priv_slots);
+    slotmap_zero(INSTANCE)(tar);
+}
+
+/*
+    Memory
+*/
+
+// Ensures slot map have at least given capacity (in total, not left)
+// May fail, O(1) else reallocation time complexity
+#define slotmap_reserve(inst) RIFF_INST(slotmap_reserve, inst)
+
+RIFF_API(int) slotmap_reserve(INSTANCE)(slotmap(INSTANCE)* tar, size_t capacity) {
+    if (tar->priv_capc >= capacity) return SCC; // already have
+    if (capacity > MAX_SIZE) return ERR;        // slots are 32 bit
+
+    // blocks which succeeded stay bigger than capacity, which is harmless
+    STORED* new_data = (STORED*)RIFF_REALLOC(tar->priv_data, capacity * sizeof(STORED));
+    if (!new_data) return ERR;
+    tar->priv_data = new_data;
+
+    uint32_t* new_slot_of = (uint32_t*)RIFF_REALLOC(tar->priv_slot_of, capacity * sizeof(uint32_t));
+    if (!new_slot_of) return ERR;
+    tar->priv_slot_of = new_slot_of;
+
+    riff_slotmap_slot* new_slots = (riff_slotmap_slot*)RIFF_REALLOC(tar->priv_slots, capacity * sizeof(riff_slotmap_slot));
+    if (!new_slots) return ERR;
+    tar->priv_slots = new_slots;
+
+    tar->priv_capc = capacity;
+    return SCC;
+}
+
+/*
+    Query
+*/
+
+// Returns count of elements in the slot map
+// O(1)
+#define slotmap_size(inst) RIFF_INST(slotmap_size, inst)
+
+RIFF_API(size_t) slotmap_size(INSTANCE)(const slotmap(INSTANCE)* tar) {
+    return tar->priv_size;
+}
+
+// Returns whether handle refers to an element of the slot map (not erased yet)
+// O(1)
+#define slotmap_valid(inst) RIFF_INST(slotmap_valid, inst)
+
+RIFF_API(int) slotmap_valid(INSTANCE)(const slotmap(INSTANCE)* tar, riff_slotmap_handle handle) {
+    return handle.index < tar->priv_slots_used && tar->priv_slots[handle.index].generation == handle.generation;
+}
+
+/*
+    Access
+*/
+
+// Returns pointer to the element of given handle, NULL if the handle is stale
+// Pointer is invalidated by insertions and erasures, the handle is not
+// O(1)
+#define slotmap_get(inst) RIFF_INST(slotmap_get, inst)
+
+RIFF_API(STORED*) slotmap_get(INSTANCE)(slotmap(INSTANCE)* tar, riff_slotmap_handle handle) {
+    if (!slotmap_valid(INSTANCE)(tar, handle)) return NULL;
+    return &tar->priv_data[tar->priv_slots[handle.index].index];
+}
+
+// Returns pointer to first element of the dense array, the first slotmap_size() elements are valid
+// You can change given elements, but must keep them valid, as destructor (if provided)
+// will be called on them sooner or later
+// O(1)
+#define slotmap_access(inst) RIFF_INST(slotmap_access, inst)
+
+RIFF_API(STORED*) slotmap_access(INSTANCE)(slotmap(INSTANCE)* tar) {
+    return tar->priv_data;
+}
+
+// Returns pointer to first element of the dense array, the first slotmap_size() elements are valid
+// O(1)
+#define slotmap_const_access(inst) RIFF_INST(slotmap_const_access, inst)
+
+RIFF_API(const STORED*) slotmap_const_access(INSTANCE)(const slotmap(INSTANCE)* tar) {
+    return tar->priv_data;
+}
+
+// Returns handle of the element at given dense position (pos < slotmap_size())
+// O(1)
+#define slotmap_handle_at(inst) RIFF_INST(slotmap_handle_at, inst)
+
+RIFF_API(riff_slotmap_handle) slotmap_handle_at(INSTANCE)(const slotmap(INSTANCE)* tar, size_t pos) {
+    riff_slotmap_handle handle;
+    handle.index      = tar->priv_slot_of[pos];
+    handle.generation = tar->priv_slots[handle.index].generation;
+    return handle;
+}
+
+/*
+    Operations
+*/
+
+// Inserts element, its handle is written into *handle (if not NULL)
+// If succeeded slot map is now the owner of the object
+// May cause reallocation - pointers to elements are invalidated, handles are not
+// May fail (allocation, or 2^32 - 1 elements), O(1) average
+#define slotmap_insert(inst) RIFF_INST(slotmap_insert, inst)
+
+RIFF_API(int) slotmap_insert(INSTANCE)(slotmap(INSTANCE)* tar, STORED value, riff_slotmap_handle* handle) {
+    if (tar->priv_size == tar->priv_capc) {
+        size_t new_capc = tar->priv_capc ? tar->priv_capc * 2 : 4;
+        if (new_capc > MAX_SIZE) new_capc = MAX_SIZE;
+        if (slotmap_reserve(INSTANCE)(tar, new_capc) == ERR || tar->priv_size == tar->priv_capc) return ERR;
+    }
+
+    // reuse a free slot, else take a new one
+    uint32_t slot;
+    if (tar->priv_free) {
+        slot           = tar->priv_free - 1;
+        tar->priv_free = tar->priv_slots[slot].index;
+    }
+    else {
+        slot = (uint32_t)tar->priv_slots_used++;
+        tar->priv_slots[slot].generation = 1;
+    }
+
+    size_t pos = tar->priv_size++;
+    tar->priv_data[pos]         = value;
+    tar->priv_slot_of[pos]      = slot;
+    tar->priv_slots[slot].index = (uint32_t)pos;
+
+    if (handle) {
+        handle->index      = slot;
+        handle->generation = tar->priv_slots[slot].generation;
+    }
+    return SCC;
+}
+
+// Erases element of given handle, the handle becomes stale
+// If out is NULL destructor (if provided) will be called on the element
+// Else element will be moved into *out
+// The last element of the dense array takes its position
+// May fail (stale handle), O(1)
+#define slotmap_erase(inst) RIFF_INST(slotmap_erase, inst)
+
+RIFF_API(int) slotmap_erase(INSTANCE)(slotmap(INSTANCE)* tar, riff_slotmap_handle handle, STORED* out) {
+    if (!slotmap_valid(INSTANCE)(tar, handle)) return ERR;
+
+    riff_slotmap_slot* slot = &tar->priv_slots[handle.index];
+    size_t pos  = slot->index;
+    size_t last = tar->priv_size - 1;
+
+    if (out) *out = tar->priv_data[pos];
+    else     { DESTROY(&tar->priv_data[pos]); }
+
+    // fill the hole with the last element
+    if (pos != last) {
+        tar->priv_data[pos]    = tar->priv_data[last];
+        tar->priv_slot_of[pos] = tar->priv_slot_of[last];
+        tar->priv_slots[tar->priv_slot_of[pos]].index = (uint32_t)pos;
+    }
+    tar->priv_size--;
+
+    // retire the slot, generation 0 is skipped on wrap around so zero handles stay invalid
+    if (++slot->generation == 0) slot->generation = 1;
+    slot->index    = tar->priv_free;
+    tar->priv_free = handle.index + 1;
+    return SCC;
+}
+
+// Erases all elements with destructor if provided, all handles become stale
+// Does not reduce capacity
+// O(n)
+#define slotmap_clear(inst) RIFF_INST(slotmap_clear, inst)
+
+RIFF_API(void) slotmap_clear(INSTANCE)(slotmap(INSTANCE)* tar) {
+    for (size_t pos = 0; pos < tar->priv_size; pos++) {
+        DESTROY(&tar->priv_data[pos]);
+
+        uint32_t           s    = tar->priv_slot_of[pos];
+        riff_slotmap_slot* slot = &tar->priv_slots[s];
+        if (++slot->generation == 0) slot->generation = 1;
+        slot->index    = tar->priv_free;
+        tar->priv_free = s + 1;
+    }
+    tar->priv_size = 0;
+}
+
+#undef DESTROY
+#undef MAX_SIZE
+
+#undef INSTANCE
+#undef STORED
+#undef DESTRUCTOR
+#undef TRIVIAL
+
+// consume parameters
+#undef T
+#undef A
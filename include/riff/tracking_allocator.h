@@ -0,0 +1,222 @@
+/*
+    T macro pattern
+        [instance name],
+        [counters object - riff_track_counters lvalue, e.g. a global, shared by every user of the instance]
+
+    A macro is the wrapped (inner) allocator
+    Instance provides an allocator triple, to be used as A of containers:
+        #define A track_alloc(inst), track_realloc(inst), track_free(inst)
+    which forwards to the inner allocator and records live / peak bytes, call counts,
+    realloc copy volume and a histogram of requested sizes into the counters object
+    Counters are updated atomically (GCC / Clang builtins), so the instance can be shared by threads
+    Every block is prefixed with a header holding its size, so blocks must be freed by the same instance
+    The counters object must be declared before inclusion, the type is complete after it:
+        extern struct riff_track_counters my_counters;
+        ... include ...
+        riff_track_counters my_counters; // in exactly one translation unit
+*/
+
+#include "generic.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef T
+    #error No "T" macro defined at the time of inclusion. Note T macros are undef at the end of every data structure header.
+#endif
+
+#ifndef A
+    #error No "A" macro defined at the time of inclusion. Note A macros are undef at the end of every data structure header.
+#endif
+
+/*
+    Counters
+*/
+
+#ifndef RIFF_TRACK_COUNTERS
+#define RIFF_TRACK_COUNTERS
+
+// size histogram buckets, bucket b counts requests of [2^b, 2^(b+1)) bytes (0 bytes go to bucket 0)
+#define RIFF_TRACK_BUCKETS 64
+
+// Tracking allocator counters
+// Zero-initialized object is a valid, empty one
+typedef struct riff_track_counters {
+    size_t live_bytes;         // bytes currently allocated
+    size_t peak_bytes;         // highest live_bytes
+    size_t total_bytes;        // bytes requested in total (allocs and reallocs)
+    size_t allocs;             // successful alloc calls (and realloc of NULL)
+    size_t reallocs;           // successful realloc calls of non-NULL blocks
+    size_t frees;              // free calls of non-NULL blocks
+    size_t failures;           // alloc / realloc calls the inner allocator failed
+    size_t realloc_moves;      // reallocs which moved the block
+    size_t realloc_copy_bytes; // bytes copied by moving reallocs
+    size_t hist[RIFF_TRACK_BUCKETS];
+} riff_track_counters;
+
+// block header, keeps user memory aligned as the inner allocator does
+typedef union riff_track_header {
+    size_t      size;
+    max_align_t align;
+} riff_track_header;
+
+RIFF_API(size_t) riff_track_internal_load(const size_t* c) {
+    return __atomic_load_n(c, __ATOMIC_RELAXED);
+}
+
+RIFF_API(void) riff_track_internal_add(size_t* c, size_t v) {
+    __atomic_fetch_add(c, v, __ATOMIC_RELAXED);
+}
+
+RIFF_API(void) riff_track_internal_bucket(riff_track_counters* c, size_t size) {
+    size_t b = size ? (size_t)(63 - __builtin_clzll((unsigned long long)size)) : 0;
+    riff_track_internal_add(&c->hist[b], 1);
+}
+
+// live bytes grow by size, peak follows
+RIFF_API(void) riff_track_internal_grow(riff_track_counters* c, size_t size) {
+    size_t live = __atomic_add_fetch(&c->live_bytes, size, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&c->peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(&c->peak_bytes, &peak, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+RIFF_API(void) riff_track_internal_shrink(riff_track_counters* c, size_t size) {
+    __atomic_fetch_sub(&c->live_bytes, size, __ATOMIC_RELAXED);
+}
+
+// Returns consistent-enough copy of the counters (each counter is read atomically)
+// O(1)
+RIFF_API(riff_track_counters) riff_track_snapshot(const riff_track_counters* c) {
+    riff_track_counters out;
+    out.live_bytes         = riff_track_internal_load(&c->live_bytes);
+    out.peak_bytes         = riff_track_internal_load(&c->peak_bytes);
+    out.total_bytes        = riff_track_internal_load(&c->total_bytes);
+    out.allocs             = riff_track_internal_load(&c->allocs);
+    out.reallocs           = riff_track_internal_load(&c->reallocs);
+    out.frees              = riff_track_internal_load(&c->frees);
+    out.failures           = riff_track_internal_load(&c->failures);
+    out.realloc_moves      = riff_track_internal_load(&c->realloc_moves);
+    out.realloc_copy_bytes = riff_track_internal_load(&c->realloc_copy_bytes);
+    for (int b = 0; b < RIFF_TRACK_BUCKETS; b++) out.hist[b] = riff_track_internal_load(&c->hist[b]);
+    return out;
+}
+
+// Resets every counter but live_bytes, peak_bytes starts again from live_bytes
+// Must not race with allocations of the tracked instance
+// O(1)
+RIFF_API(void) riff_track_reset(riff_track_counters* c) {
+    size_t live = c->live_bytes;
+    riff_track_counters zero = { 0 };
+    *c = zero;
+    c->live_bytes = live;
+    c->peak_bytes = live;
+}
+
+// Prints counters in human readable form, histogram rows only for non-empty buckets
+// O(1)
+RIFF_API(void) riff_track_dump(const riff_track_counters* c, FILE* out) {
+    riff_track_counters s = riff_track_snapshot(c);
+    fprintf(out, "live bytes:         %zu\n", s.live_bytes);
+    fprintf(out, "peak bytes:         %zu\n", s.peak_bytes);
+    fprintf(out, "total bytes:        %zu\n", s.total_bytes);
+    fprintf(out, "allocs:             %zu\n", s.allocs);
+    fprintf(out, "reallocs:           %zu\n", s.reallocs);
+    fprintf(out, "frees:              %zu\n", s.frees);
+    fprintf(out, "failures:           %zu\n", s.failures);
+    fprintf(out, "realloc moves:      %zu\n", s.realloc_moves);
+    fprintf(out, "realloc copy bytes: %zu\n", s.realloc_copy_bytes);
+    fprintf(out, "request sizes:\n");
+    for (int b = 0; b < RIFF_TRACK_BUCKETS; b++) {
+        if (!s.hist[b]) continue;
+        fprintf(out, "  [%zu, %zu): %zu\n", b ? (size_t)1 << b : (size_t)0, (size_t)1 << b << 1, s.hist[b]);
+    }
+}
+
+#endif // RIFF_TRACK_COUNTERS
+
+/*
+    Unpack and Helpers
+*/
+
+#define INSTANCE RIFF_FIRST(T)
+#define COUNTERS RIFF_SECOND(T)
+
+#define HEADER sizeof(riff_track_header)
+
+/*
+    Allocator
+*/
+
+// Allocates size bytes through the inner allocator, NULL on failure
+// O(1) else inner allocation time complexity
+#define track_alloc(inst) RIFF_INST(track_alloc, inst)
+
+RIFF_API(void*) track_alloc(INSTANCE)(size_t size) {
+    riff_track_header* h = (riff_track_header*)RIFF_ALLOC(HEADER + size);
+    if (!h) {
+        riff_track_internal_add(&(COUNTERS).failures, 1);
+        return NULL;
+    }
+    h->size = size;
+
+    riff_track_internal_add(&(COUNTERS).allocs, 1);
+    riff_track_internal_add(&(COUNTERS).total_bytes, size);
+    riff_track_internal_bucket(&(COUNTERS), size);
+    riff_track_internal_grow(&(COUNTERS), size);
+    return h + 1;
+}
+
+// Frees block of the instance, NULL is ignored
+// O(1) else inner free time complexity
+#define track_free(inst) RIFF_INST(track_free, inst)
+
+RIFF_API(void) track_free(INSTANCE)(void* ptr) {
+    if (!ptr) return;
+    riff_track_header* h = (riff_track_header*)ptr - 1;
+
+    riff_track_internal_add(&(COUNTERS).frees, 1);
+    riff_track_internal_shrink(&(COUNTERS), h->size);
+    RIFF_FREE(h);
+}
+
+// Resizes block of the instance to size bytes, NULL ptr allocates a new one
+// On failure NULL is returned and the block is left untouched
+// O(1) else inner reallocation time complexity
+#define track_realloc(inst) RIFF_INST(track_realloc, inst)
+
+RIFF_API(void*) track_realloc(INSTANCE)(void* ptr, size_t size) {
+    if (!ptr) return track_alloc(INSTANCE)(size);
+
+    riff_track_header* old_h    = (riff_track_header*)ptr - 1;
+    size_t             old_size = old_h->size;
+    uintptr_t          old_addr = (uintptr_t)old_h;
+
+    riff_track_header* h = (riff_track_header*)RIFF_REALLOC(old_h, HEADER + size);
+    if (!h) {
+        riff_track_internal_add(&(COUNTERS).failures, 1);
+        return NULL;
+    }
+    h->size = size;
+
+    riff_track_internal_add(&(COUNTERS).reallocs, 1);
+    riff_track_internal_add(&(COUNTERS).total_bytes, size);
+    riff_track_internal_bucket(&(COUNTERS), size);
+    if ((uintptr_t)h != old_addr) {
+        riff_track_internal_add(&(COUNTERS).realloc_moves, 1);
+        riff_track_internal_add(&(COUNTERS).realloc_copy_bytes, old_size < size ? old_size : size);
+    }
+
+    if (size > old_size) riff_track_internal_grow(&(COUNTERS), size - old_size);
+    else                 riff_track_internal_shrink(&(COUNTERS), old_size - size);
+    return h + 1;
+}
+
+#undef HEADER
+
+#undef INSTANCE
+#undef COUNTERS
+
+// consume parameters
+#undef T
+#undef A